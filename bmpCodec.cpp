@@ -0,0 +1,214 @@
+#include "bmpCodec.h"
+#include "byteOrder.h"
+#include <cstring>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr size_t kFileHeaderSize = 14;
+constexpr size_t kInfoHeaderSize = 40;
+constexpr size_t kInfoHeaderV3Size = 56; // BITMAPV3INFOHEADER：BITMAPINFOHEADER 之后是 RGBA 四个掩码
+constexpr uint32_t kCompressionRgb = 0;
+constexpr uint32_t kCompressionBitfields = 3;
+
+size_t bmpRowSize(uint32_t width, uint32_t bitCount) {
+    return ((static_cast<size_t>(width) * bitCount + 31) / 32) * 4;
+}
+
+// 调色板像素展开：灰度调色板输出 1 通道，否则输出 BGR
+void expandIndexed(const unsigned char* rows, ptrdiff_t rowStep, uint32_t width, uint32_t height,
+                   uint32_t bitCount, const unsigned char* palette, size_t colors, bool gray,
+                   BmpImage& image) {
+    const uint8_t channels = gray ? 1 : 3;
+    const uint32_t perByte = 8 / bitCount;
+    const unsigned mask = (1u << bitCount) - 1;
+
+    image.channels = channels;
+    image.stride = static_cast<size_t>(width) * channels;
+    image.storage.assign(image.stride * height, 0);
+    for (uint32_t y = 0; y < height; ++y) {
+        const unsigned char* in = rows + static_cast<ptrdiff_t>(y) * rowStep;
+        unsigned char* out = image.storage.data() + y * image.stride;
+        for (uint32_t x = 0; x < width; ++x) {
+            const unsigned shift = 8 - bitCount * (x % perByte + 1);
+            const size_t index = (in[x / perByte] >> shift) & mask;
+            if (index >= colors) continue; // 越界索引按黑色处理
+            const unsigned char* entry = palette + index * 4;
+            if (gray) {
+                out[x] = entry[0];
+            } else {
+                out[x * 3] = entry[0];
+                out[x * 3 + 1] = entry[1];
+                out[x * 3 + 2] = entry[2];
+            }
+        }
+    }
+    image.pixels = image.storage.data();
+}
+
+} // namespace
+
+bool isBmpData(const unsigned char* data, size_t size) {
+    return size >= kFileHeaderSize + kInfoHeaderSize && data[0] == 'B' && data[1] == 'M';
+}
+
+bool readBmp(const unsigned char* data, size_t size, BmpImage& image) {
+    if (!isBmpData(data, size)) return false;
+
+    const size_t pixelOffset = readLE32(data + 10);
+    const unsigned char* info = data + kFileHeaderSize;
+    const uint32_t infoSize = readLE32(info);
+    if (infoSize < kInfoHeaderSize || kFileHeaderSize + infoSize > size) return false;
+
+    const int32_t width = static_cast<int32_t>(readLE32(info + 4));
+    const int32_t rawHeight = static_cast<int32_t>(readLE32(info + 8));
+    const uint16_t planes = readLE16(info + 12);
+    const uint16_t bitCount = readLE16(info + 14);
+    const uint32_t compression = readLE32(info + 16);
+    const uint32_t colorsUsed = readLE32(info + 32);
+    if (width <= 0 || rawHeight == 0 || rawHeight == INT32_MIN || planes != 1) return false;
+
+    // BI_BITFIELDS 只接受与 BI_RGB 等价的 32 位 BGRA 掩码；V3 及以上的信息头还带 Alpha 掩码
+    size_t paletteOffset = kFileHeaderSize + infoSize;
+    bool alpha = false;
+    if (compression == kCompressionBitfields) {
+        if (bitCount != 32) return false;
+        const unsigned char* masks = info + kInfoHeaderSize;
+        if (infoSize == kInfoHeaderSize) {
+            if (paletteOffset + 12 > size) return false;
+            paletteOffset += 12;
+        } else if (infoSize < kInfoHeaderSize + 12) {
+            return false;
+        }
+        if (readLE32(masks) != 0x00FF0000u || readLE32(masks + 4) != 0x0000FF00u
+            || readLE32(masks + 8) != 0x000000FFu) {
+            return false;
+        }
+        alpha = infoSize >= kInfoHeaderSize + 16 && readLE32(masks + 12) == 0xFF000000u;
+    } else if (compression != kCompressionRgb) {
+        return false;
+    }
+    if (bitCount != 1 && bitCount != 4 && bitCount != 8 && bitCount != 24 && bitCount != 32) return false;
+
+    const bool topDown = rawHeight < 0;
+    const uint32_t w = static_cast<uint32_t>(width);
+    const uint32_t h = static_cast<uint32_t>(topDown ? -rawHeight : rawHeight);
+    const size_t rowSize = bmpRowSize(w, bitCount);
+    // 最后一行允许省略填充字节
+    const size_t lastRowBytes = (static_cast<size_t>(w) * bitCount + 7) / 8;
+    if (pixelOffset > size || size - pixelOffset < lastRowBytes
+        || (size - pixelOffset - lastRowBytes) / rowSize < h - 1) {
+        return false;
+    }
+
+    // 统一为自上而下：自底向上的文件从最后一行开始反向读取
+    const unsigned char* firstRow = data + pixelOffset + (topDown ? 0 : (h - 1) * rowSize);
+    const ptrdiff_t rowStep = topDown ? static_cast<ptrdiff_t>(rowSize) : -static_cast<ptrdiff_t>(rowSize);
+
+    image = BmpImage();
+    image.width = w;
+    image.height = h;
+
+    if (bitCount <= 8) {
+        const size_t maxColors = size_t(1) << bitCount;
+        const size_t colors = (colorsUsed == 0 || colorsUsed > maxColors) ? maxColors : colorsUsed;
+        if (paletteOffset + colors * 4 > pixelOffset) return false;
+        const unsigned char* palette = data + paletteOffset;
+
+        bool gray = true;
+        bool identity = bitCount == 8 && colors == 256;
+        for (size_t i = 0; i < colors && gray; ++i) {
+            const unsigned char* entry = palette + i * 4;
+            gray = entry[0] == entry[1] && entry[1] == entry[2];
+            identity = identity && entry[0] == i;
+        }
+
+        // 8 位恒等灰度调色板的索引就是灰度值，自顶向下时可直接引用
+        if (identity && topDown) {
+            image.channels = 1;
+            image.pixels = firstRow;
+            image.stride = rowSize;
+            return true;
+        }
+        expandIndexed(firstRow, rowStep, w, h, bitCount, palette, colors, gray, image);
+        return true;
+    }
+
+    image.channels = static_cast<uint8_t>(bitCount / 8);
+    image.alpha = alpha;
+    if (topDown) {
+        image.pixels = firstRow;
+        image.stride = rowSize;
+        return true;
+    }
+
+    // 自底向上只需按行翻转拷贝，不涉及解码
+    image.stride = static_cast<size_t>(w) * image.channels;
+    image.storage.resize(image.stride * h);
+    for (uint32_t y = 0; y < h; ++y) {
+        std::memcpy(image.storage.data() + y * image.stride,
+                    firstRow + static_cast<ptrdiff_t>(y) * rowStep, image.stride);
+    }
+    image.pixels = image.storage.data();
+    return true;
+}
+
+bool writeBmp(const unsigned char* pixels, size_t stride, uint32_t width, uint32_t height,
+              uint8_t channels, bool alpha, std::vector<unsigned char>& out) {
+    if (width == 0 || height == 0 || width > INT32_MAX || height > INT32_MAX) return false;
+    if (channels != 1 && channels != 3 && channels != 4) return false;
+
+    const bool bitfields = channels == 4 && alpha;
+    const uint32_t bitCount = channels * 8u;
+    const size_t infoSize = bitfields ? kInfoHeaderV3Size : kInfoHeaderSize;
+    const size_t paletteSize = channels == 1 ? 256 * 4 : 0;
+    const size_t rowSize = bmpRowSize(width, bitCount);
+    const size_t rowBytes = static_cast<size_t>(width) * channels;
+    const size_t pixelOffset = kFileHeaderSize + infoSize + paletteSize;
+    const size_t fileSize = pixelOffset + rowSize * height;
+    if (fileSize > UINT32_MAX) return false;
+
+    out.assign(pixelOffset, 0);
+    out.resize(fileSize);
+    unsigned char* header = out.data();
+    header[0] = 'B';
+    header[1] = 'M';
+    writeLE32(header + 2, static_cast<uint32_t>(fileSize));
+    writeLE32(header + 10, static_cast<uint32_t>(pixelOffset));
+
+    unsigned char* info = header + kFileHeaderSize;
+    writeLE32(info, static_cast<uint32_t>(infoSize));
+    writeLE32(info + 4, width);
+    writeLE32(info + 8, height); // 正高度：自底向上，兼容性最好
+    writeLE16(info + 12, 1);
+    writeLE16(info + 14, bitCount);
+    writeLE32(info + 16, bitfields ? kCompressionBitfields : kCompressionRgb);
+    writeLE32(info + 20, static_cast<uint32_t>(rowSize * height));
+    writeLE32(info + 24, 2835); // 72 DPI
+    writeLE32(info + 28, 2835);
+    if (bitfields) {
+        // 带 Alpha 掩码，读取端（包括 readBmp）才会把第 4 字节当作 Alpha 而不是保留字节
+        writeLE32(info + kInfoHeaderSize, 0x00FF0000u);
+        writeLE32(info + kInfoHeaderSize + 4, 0x0000FF00u);
+        writeLE32(info + kInfoHeaderSize + 8, 0x000000FFu);
+        writeLE32(info + kInfoHeaderSize + 12, 0xFF000000u);
+    }
+
+    unsigned char* palette = info + infoSize;
+    for (size_t i = 0; i < paletteSize / 4; ++i) {
+        palette[i * 4] = palette[i * 4 + 1] = palette[i * 4 + 2] = static_cast<unsigned char>(i);
+    }
+
+    const size_t padding = rowSize - rowBytes;
+    for (uint32_t y = 0; y < height; ++y) {
+        unsigned char* row = out.data() + pixelOffset + static_cast<size_t>(height - 1 - y) * rowSize;
+        std::memcpy(row, pixels + y * stride, rowBytes);
+        if (padding != 0) std::memset(row + rowBytes, 0, padding);
+    }
+    return true;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,38 @@
+#ifndef BMPCODEC_H
+#define BMPCODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 解析后的 BMP 像素视图：行序统一为自上而下，通道顺序与 cv::Mat 一致（GRAY / BGR / BGRA 或 BGRX）
+    struct BmpImage {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint8_t channels = 0;
+        bool alpha = false; // 4 通道时第 4 字节是否为 Alpha（BI_BITFIELDS 带 Alpha 掩码）；BI_RGB 的第 4 字节是保留字节
+        const unsigned char* pixels = nullptr; // 第一行（最上方）像素
+        size_t stride = 0;                     // 每行字节数（含填充）
+        std::vector<unsigned char> storage;    // 无法直接引用文件数据时（调色板、自底向上）的像素缓冲
+    };
+
+    // 判断数据是否为 BMP 文件
+    bool isBmpData(const unsigned char* data, size_t size);
+
+    // 解析 1/4/8/24/32 位未压缩 BMP（含 BI_BITFIELDS 标准掩码），支持自底向上/自顶向下和行填充。
+    // 自顶向下的 24/32 位及灰度调色板 8 位图像直接引用 data，调用方需保证 data 在使用期间有效；
+    // RLE 压缩、16 位等不支持的格式返回 false，由调用方退回通用解码器
+    bool readBmp(const unsigned char* data, size_t size, BmpImage& image);
+
+    // 把自上而下的像素写成 BMP 文件（1 通道写 8 位灰度调色板，3 通道 24 位，4 通道 32 位）。
+    // 4 通道且 alpha 为 true 时写带 Alpha 掩码的 BI_BITFIELDS，否则第 4 字节按 BI_RGB 的保留字节写出
+    bool writeBmp(const unsigned char* pixels, size_t stride, uint32_t width, uint32_t height,
+                  uint8_t channels, bool alpha, std::vector<unsigned char>& out);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // BMPCODEC_H
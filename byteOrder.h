@@ -0,0 +1,49 @@
+#ifndef BYTEORDER_H
+#define BYTEORDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // zstd 可跳过帧的帧头：LE32 魔数 | LE32 内容长度
+    constexpr size_t kSkippableHeaderSize = 8;
+
+    // 各容器格式共用的小端读写，文件中的多字节字段一律按小端存储
+    inline uint16_t readLE16(const unsigned char* src) {
+        return static_cast<uint16_t>(src[0] | (src[1] << 8));
+    }
+
+    inline void writeLE16(unsigned char* dst, uint32_t value) {
+        dst[0] = static_cast<unsigned char>(value);
+        dst[1] = static_cast<unsigned char>(value >> 8);
+    }
+
+    inline uint32_t readLE32(const unsigned char* src) {
+        return static_cast<uint32_t>(src[0])
+             | (static_cast<uint32_t>(src[1]) << 8)
+             | (static_cast<uint32_t>(src[2]) << 16)
+             | (static_cast<uint32_t>(src[3]) << 24);
+    }
+
+    inline void writeLE32(unsigned char* dst, uint32_t value) {
+        dst[0] = static_cast<unsigned char>(value);
+        dst[1] = static_cast<unsigned char>(value >> 8);
+        dst[2] = static_cast<unsigned char>(value >> 16);
+        dst[3] = static_cast<unsigned char>(value >> 24);
+    }
+
+    inline uint64_t readLE64(const unsigned char* src) {
+        return static_cast<uint64_t>(readLE32(src)) | (static_cast<uint64_t>(readLE32(src + 4)) << 32);
+    }
+
+    inline void writeLE64(unsigned char* dst, uint64_t value) {
+        writeLE32(dst, static_cast<uint32_t>(value));
+        writeLE32(dst + 4, static_cast<uint32_t>(value >> 32));
+    }
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // BYTEORDER_H
@@ -16,7 +16,8 @@ zstd_compressor::ImageFormat CompressWorker::convertFormat(int format) const
     static const QHash<int, zstd_compressor::ImageFormat> formatMap = {
         {0, zstd_compressor::ImageFormat::FORMAT_BMP},
         {1, zstd_compressor::ImageFormat::FORMAT_PNG},
-        {2, zstd_compressor::ImageFormat::FORMAT_JPEG}
+        {2, zstd_compressor::ImageFormat::FORMAT_JPEG},
+        {3, zstd_compressor::ImageFormat::FORMAT_RAW}
     };
 
     return formatMap.value(format, zstd_compressor::ImageFormat::FORMAT_BMP);
@@ -110,7 +110,7 @@ void MainWindow::setupUI()
 
     QLabel *formatLabel = new QLabel("输出格式:", this);
     formatCombo = new QComboBox(this);
-    formatCombo->addItems({"BMP", "PNG", "JPEG"});
+    formatCombo->addItems({"BMP", "PNG", "JPEG", "RAW"});
     formatCombo->setCurrentIndex(0);
 
     QLabel *levelLabel = new QLabel("压缩级别:", this);
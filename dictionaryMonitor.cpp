@@ -0,0 +1,228 @@
+#include "dictionaryMonitor.h"
+#include "imageDictionary.h"
+#include <zstd.h>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr size_t kWindowCompressions = 64; // 每个统计窗口包含的压缩次数
+
+// 用字典压缩全部样本后的总大小，用来比较新旧字典；失败时返回最大值
+size_t compressedTotal(const std::vector<unsigned char>& dictionary, int level,
+                       const std::vector<std::vector<unsigned char>>& samples) {
+    ZSTD_CDict* cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(), level);
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    size_t total = cdict && cctx ? 0 : std::numeric_limits<size_t>::max();
+    std::vector<unsigned char> out;
+    for (size_t i = 0; i < samples.size() && total != std::numeric_limits<size_t>::max(); ++i) {
+        const auto& sample = samples[i];
+        out.resize(ZSTD_compressBound(sample.size()));
+        const size_t size = ZSTD_compress_usingCDict(cctx, out.data(), out.size(), sample.data(), sample.size(),
+                                                     cdict);
+        if (ZSTD_isError(size)) {
+            total = std::numeric_limits<size_t>::max();
+            break;
+        }
+        total += size;
+    }
+    ZSTD_freeCCtx(cctx);
+    ZSTD_freeCDict(cdict);
+    return total;
+}
+
+// 把字典保存为 folder/<字典 ID>.dict 并加入注册表。先写临时文件再改名，其它进程扫描目录时
+// 不会读到写了一半的字典；临时文件名各不相同，多个线程同时保存同一个字典也互不干扰
+bool persist(const std::string& folder, unsigned dictID, const unsigned char* dict, size_t dictSize) {
+    static std::atomic<unsigned> counter{ 0 };
+    const std::filesystem::path path = std::filesystem::path(folder) / (std::to_string(dictID) + ".dict");
+    std::filesystem::path temporary = path;
+    temporary += "." + std::to_string(counter++) + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary);
+        if (!file.is_open()) return false;
+        file.write(reinterpret_cast<const char*>(dict), static_cast<std::streamsize>(dictSize));
+        if (!file.good()) return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return DictionaryRegistry::instance().add(path.string()) == dictID;
+}
+
+} // namespace
+
+DictionaryMonitor& DictionaryMonitor::instance() {
+    // 后台训练会用到注册表，先构造注册表，保证它在监测器（析构时等待训练结束）之后析构
+    DictionaryRegistry::instance();
+    static DictionaryMonitor monitor;
+    return monitor;
+}
+
+DictionaryMonitor::~DictionaryMonitor() {
+    disable();
+}
+
+bool DictionaryMonitor::enable(const std::string& dictFolder, double degradation, size_t reservoirSamples) {
+    if (reservoirSamples == 0 || degradation < 0.0) return false;
+    std::error_code error;
+    std::filesystem::create_directories(dictFolder, error);
+    if (!std::filesystem::is_directory(dictFolder, error)) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_folder = dictFolder;
+    m_degradation = degradation;
+    m_reservoirSamples = reservoirSamples;
+    m_enabled.store(true, std::memory_order_release);
+    return true;
+}
+
+void DictionaryMonitor::disable() {
+    m_enabled.store(false, std::memory_order_release);
+    wait();
+}
+
+void DictionaryMonitor::wait() {
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        worker = std::move(m_worker);
+    }
+    if (worker.joinable()) worker.join();
+}
+
+void DictionaryMonitor::record(const unsigned char* dict, size_t dictSize, int level, size_t originalSize,
+                               size_t compressedSize, const unsigned char* sample, size_t sampleSize) {
+    if (!enabled() || originalSize == 0) return;
+    const unsigned dictID = ZSTD_getDictID_fromDict(dict, dictSize);
+    if (dictID == 0) return;
+
+    bool known = false;
+    std::string folder;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        known = m_states.count(dictID) != 0;
+        folder = m_folder;
+    }
+    // 第一次见到的字典先保存并注册：重新训练之后，用它压缩的数据仍要能按 ID 解压。
+    // 文件读写和映射不持有锁，其它线程的统计不受影响
+    if (!known && !DictionaryRegistry::instance().find(dictID) && !persist(folder, dictID, dict, dictSize)) return;
+
+    size_t slot = SIZE_MAX;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        State& state = m_states[dictID];
+        if (state.successor != 0) return;
+
+        state.windowOriginal += originalSize;
+        state.windowCompressed += compressedSize;
+        if (++state.windowCount == kWindowCompressions) {
+            if (!state.hasBaseline) {
+                state.baselineOriginal = state.windowOriginal;
+                state.baselineCompressed = state.windowCompressed;
+                state.hasBaseline = true;
+            } else {
+                const double baseline = static_cast<double>(state.baselineCompressed) / state.baselineOriginal;
+                const double current = static_cast<double>(state.windowCompressed) / state.windowOriginal;
+                state.degraded = current > baseline * (1.0 + m_degradation);
+                // 压缩率恢复正常时丢弃水库，留下的样本都来自最近一次变差以来的输入
+                if (!state.degraded && !state.reservoir.empty()) {
+                    state.reservoir.clear();
+                    state.seen = 0;
+                    ++state.generation;
+                }
+            }
+            state.windowOriginal = 0;
+            state.windowCompressed = 0;
+            state.windowCount = 0;
+        }
+        if (!state.degraded) return;
+
+        // 水库抽样（算法 R）：每个输入以 容量/已见数 的概率留下，替换随机一个旧样本。
+        // 这里只占位，样本在锁外复制
+        ++state.seen;
+        if (state.reservoir.size() < m_reservoirSamples) {
+            slot = state.reservoir.size();
+            state.reservoir.emplace_back();
+        } else {
+            const uint64_t candidate = m_random() % state.seen;
+            if (candidate < m_reservoirSamples) slot = static_cast<size_t>(candidate);
+        }
+        generation = state.generation;
+    }
+    if (slot == SIZE_MAX) return;
+
+    std::vector<unsigned char> copy(sample, sample + sampleSize);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    State& state = m_states[dictID];
+    // 复制期间水库被清空或交给了训练线程，样本作废
+    if (state.generation != generation || slot >= state.reservoir.size()) return;
+    state.reservoir[slot].swap(copy);
+
+    // 同一时间只训练一个字典；水库装满才训练，样本太少训练出的字典没有意义
+    if (!state.degraded || m_training || state.reservoir.size() < m_reservoirSamples) return;
+    m_training = true;
+    state.degraded = false;
+    state.seen = 0;
+    ++state.generation;
+    if (m_worker.joinable()) m_worker.join(); // 上一次训练已经结束
+    m_worker = std::thread(&DictionaryMonitor::retrain, this, m_folder, dictID,
+                           std::vector<unsigned char>(dict, dict + dictSize), level, std::move(state.reservoir));
+    state.reservoir.clear();
+}
+
+unsigned DictionaryMonitor::latest(unsigned dictID) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_states.find(dictID); it != m_states.end() && it->second.successor != 0;
+         it = m_states.find(dictID)) {
+        dictID = it->second.successor;
+    }
+    return dictID;
+}
+
+void DictionaryMonitor::retrain(std::string folder, unsigned dictID, std::vector<unsigned char> dictionary,
+                                int level, std::vector<std::vector<unsigned char>> samples) {
+    std::vector<unsigned char> data;
+    std::vector<size_t> sizes;
+    for (const auto& sample : samples) {
+        if (sample.empty()) continue;
+        data.insert(data.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    // 在后台只用一个线程训练，不与压缩争抢 CPU；新字典在同一批样本上确实更好才发布
+    std::vector<unsigned char> trained;
+    std::string error;
+    bool published = !sizes.empty()
+        && trainDictionary(data.data(), sizes, dictionary.size(), level, 1, trained, error);
+    const unsigned trainedID = published ? ZSTD_getDictID_fromDict(trained.data(), trained.size()) : 0;
+    published = trainedID != 0 && trainedID != dictID && !DictionaryRegistry::instance().find(trainedID)
+        && compressedTotal(trained, level, samples) < compressedTotal(dictionary, level, samples);
+    // 写入目录并注册之后才设置后继，看到新 ID 的实例一定能用它压缩，解压端也一定能找到它
+    published = published && persist(folder, trainedID, trained.data(), trained.size());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    State& state = m_states[dictID];
+    if (published) {
+        state.successor = trainedID;
+    } else {
+        // 新字典没有改进时说明是数据本身变了，以当前压缩率重新建立基准
+        state.hasBaseline = false;
+        state.windowOriginal = 0;
+        state.windowCompressed = 0;
+        state.windowCount = 0;
+    }
+    m_training = false;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,71 @@
+#ifndef DICTIONARYMONITOR_H
+#define DICTIONARYMONITOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 字典老化监测：按字典 ID 统计每个窗口（固定次数的压缩）的压缩率，与该字典最初一个窗口的基准比较。
+    // 压缩率变差超过阈值时，用水库抽样保存的近期输入在后台线程重新训练字典；新字典写入字典目录、
+    // 加入注册表之后才发布为旧字典的后继，旧字典同样保存在目录和注册表中，始终可以解压
+    class DictionaryMonitor {
+    public:
+        static DictionaryMonitor& instance();
+        ~DictionaryMonitor();
+
+        // degradation 为相对基准允许的压缩率变差比例，reservoirSamples 为重新训练使用的样本数
+        bool enable(const std::string& dictFolder, double degradation, size_t reservoirSamples);
+        // 停止监测并等待正在进行的训练结束，已发布的后继保留
+        void disable();
+        bool enabled() const { return m_enabled.load(std::memory_order_acquire); }
+        void wait();
+
+        // 记录一次使用字典 dict 的压缩，sample 为送入 zstd 的数据（只在压缩率变差期间抽入水库）
+        void record(const unsigned char* dict, size_t dictSize, int level, size_t originalSize,
+                    size_t compressedSize, const unsigned char* sample, size_t sampleSize);
+        // 字典最新的后继 ID，没有重新训练过时返回 dictID 本身
+        unsigned latest(unsigned dictID) const;
+
+    private:
+        struct State {
+            uint64_t baselineOriginal = 0;
+            uint64_t baselineCompressed = 0;
+            uint64_t windowOriginal = 0;
+            uint64_t windowCompressed = 0;
+            size_t windowCount = 0;
+            bool hasBaseline = false;
+            bool degraded = false;
+            uint64_t seen = 0;       // 压缩率变差以来的样本数
+            uint64_t generation = 0; // 水库每次清空或交给训练时加 1，锁外复制的样本据此判断是否作废
+            std::vector<std::vector<unsigned char>> reservoir;
+            unsigned successor = 0;
+        };
+
+        DictionaryMonitor() = default;
+        void retrain(std::string folder, unsigned dictID, std::vector<unsigned char> dictionary, int level,
+                     std::vector<std::vector<unsigned char>> samples);
+
+        std::atomic<bool> m_enabled{ false };
+        mutable std::mutex m_mutex;
+        std::string m_folder;
+        double m_degradation = 0.1;
+        size_t m_reservoirSamples = 0;
+        std::unordered_map<unsigned, State> m_states;
+        std::mt19937_64 m_random;
+        bool m_training = false;
+        std::thread m_worker;
+    };
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // DICTIONARYMONITOR_H
@@ -0,0 +1,182 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#define ZDICT_STATIC_LINKING_ONLY
+#include "imageDictionary.h"
+#include <zdict.h>
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+
+namespace zstd_compressor {
+namespace detail {
+
+bool trainDictionary(const unsigned char* samples, const std::vector<size_t>& sizes, size_t maxDictSize,
+                     int level, int numThreads, std::vector<unsigned char>& dictionary, std::string& error) {
+    // k、d 为 0 时由 zstd 搜索，其余参数取默认值
+    ZDICT_fastCover_params_t params;
+    std::memset(&params, 0, sizeof(params));
+    params.nbThreads = static_cast<unsigned>(std::max(numThreads, 1));
+    params.zParams.compressionLevel = level;
+
+    dictionary.resize(maxDictSize);
+    const size_t size = ZDICT_optimizeTrainFromBuffer_fastCover(dictionary.data(), dictionary.size(), samples,
+                                                                sizes.data(), static_cast<unsigned>(sizes.size()),
+                                                                &params);
+    if (ZDICT_isError(size)) {
+        dictionary.clear();
+        error = ZDICT_getErrorName(size);
+        return false;
+    }
+    dictionary.resize(size);
+    return true;
+}
+
+DictionaryRegistry::Entry::~Entry() {
+    if (ddict) ZSTD_freeDDict(ddict);
+}
+
+DictionaryRegistry& DictionaryRegistry::instance() {
+    static DictionaryRegistry registry;
+    return registry;
+}
+
+unsigned DictionaryRegistry::add(const std::string& dictFile) {
+    auto entry = std::make_unique<Entry>();
+    if (!entry->file.open(dictFile)) return 0;
+    // 没有字典头的原始内容 ID 为 0，帧中无法指明，不能按 ID 选择
+    const unsigned dictID = ZSTD_getDictID_fromDict(entry->file.data(), entry->file.size());
+    if (dictID == 0) return 0;
+
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        if (m_entries.count(dictID) != 0) return dictID;
+    }
+    // 字典只在这里解析一次（熵表），之后每次解压直接引用
+    entry->ddict = ZSTD_createDDict_byReference(entry->file.data(), entry->file.size());
+    if (!entry->ddict) return 0;
+
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    m_entries.emplace(dictID, std::move(entry));
+    return dictID;
+}
+
+const ZSTD_DDict* DictionaryRegistry::find(unsigned dictID) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const auto it = m_entries.find(dictID);
+    return it == m_entries.end() ? nullptr : it->second->ddict;
+}
+
+bool DictionaryRegistry::content(unsigned dictID, const unsigned char*& data, size_t& size) const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    const auto it = m_entries.find(dictID);
+    if (it == m_entries.end()) return false;
+    data = it->second->file.data();
+    size = it->second->file.size();
+    return true;
+}
+
+std::vector<unsigned> DictionaryRegistry::ids() const {
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    std::vector<unsigned> result;
+    result.reserve(m_entries.size());
+    for (const auto& entry : m_entries) result.push_back(entry.first);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t CDictKeyHash::operator()(const CDictKey& key) const {
+    uint64_t h = key.checksum ^ (static_cast<uint64_t>(key.dictID) << 32);
+    h ^= static_cast<uint64_t>(static_cast<uint32_t>(key.level)) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h ^ (key.dedicatedSearch ? 0xFF51AFD7ED558CCDULL : 0));
+}
+
+CDictCache& CDictCache::instance() {
+    static CDictCache cache;
+    return cache;
+}
+
+std::shared_ptr<const ZSTD_CDict> CDictCache::get(const unsigned char* dict, size_t size, uint64_t checksum,
+                                                  int level, bool persistent) {
+    // 专用字典搜索只对 greedy / lazy / lazy2 策略有效，其它级别按普通方式构建
+    const ZSTD_strategy strategy = ZSTD_getCParams(level, 0, size).strategy;
+    CDictKey key;
+    key.dictID = ZSTD_getDictID_fromDict(dict, size);
+    key.checksum = checksum;
+    key.level = level;
+    key.dedicatedSearch = strategy == ZSTD_greedy || strategy == ZSTD_lazy || strategy == ZSTD_lazy2;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_entries.find(key);
+        if (it != m_entries.end()) {
+            if (auto cached = it->second.lock()) {
+                touch(cached);
+                return cached;
+            }
+        }
+    }
+
+    // 构建（高级别时可能需要几毫秒）不持有锁；并发构建同一个键时保留先放入缓存的
+    ZSTD_CCtx_params* params = ZSTD_createCCtxParams();
+    if (!params) return nullptr;
+    ZSTD_CCtxParams_init(params, level);
+    if (key.dedicatedSearch) ZSTD_CCtxParams_setParameter(params, ZSTD_c_enableDedicatedDictSearch, 1);
+    ZSTD_CDict* cdict = ZSTD_createCDict_advanced2(dict, size, persistent ? ZSTD_dlm_byRef : ZSTD_dlm_byCopy,
+                                                   ZSTD_dct_auto, params, ZSTD_defaultCMem);
+    ZSTD_freeCCtxParams(params);
+    if (!cdict) return nullptr;
+
+    std::shared_ptr<const ZSTD_CDict> handle(cdict, [](const ZSTD_CDict* p) {
+        ZSTD_freeCDict(const_cast<ZSTD_CDict*>(p));
+    });
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& entry = m_entries[key];
+    if (auto cached = entry.lock()) {
+        handle = std::move(cached);
+    } else {
+        entry = handle;
+        // 顺便清理已经释放的条目
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            it = it->second.expired() ? m_entries.erase(it) : std::next(it);
+        }
+    }
+    touch(handle);
+    return handle;
+}
+
+void CDictCache::touch(const std::shared_ptr<const ZSTD_CDict>& cdict) {
+    const auto it = std::find(m_recent.begin(), m_recent.end(), cdict);
+    if (it == m_recent.begin() && it != m_recent.end()) return;
+    if (it != m_recent.end()) m_recent.erase(it);
+    m_recent.push_front(cdict);
+    if (m_recent.size() > kRecentEntries) m_recent.pop_back();
+}
+
+void CDictCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recent.clear();
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        it = it->second.expired() ? m_entries.erase(it) : std::next(it);
+    }
+}
+
+size_t CDictCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(std::count_if(m_entries.begin(), m_entries.end(),
+                                             [](const auto& entry) { return !entry.second.expired(); }));
+}
+
+uint64_t dictionaryChecksum(const unsigned char* dict, size_t size) {
+    return XXH64(dict, size, 0);
+}
+
+size_t referenceCDict(ZSTD_CCtx* cctx, const ZSTD_CDict* cdict) {
+    const size_t code = ZSTD_CCtx_setParameter(cctx, ZSTD_c_prefetchCDictTables,
+                                               cdict ? ZSTD_ps_enable : ZSTD_ps_auto);
+    if (ZSTD_isError(code)) return code;
+    return ZSTD_CCtx_refCDict(cctx, cdict);
+}
+
+} // namespace detail
+} // namespace zstd_compressor
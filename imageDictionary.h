@@ -0,0 +1,105 @@
+#ifndef IMAGEDICTIONARY_H
+#define IMAGEDICTIONARY_H
+
+#include "mappedFile.h"
+#include <zstd.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 训练样本只取每个输入的开头部分：大图像的尾部对训练几乎没有帮助，却会拖慢训练
+    constexpr size_t kMaxDictionarySampleBytes = 128 * 1024;
+
+    // 用 fastCover 训练 zstd 字典：在多组 (k, d) 参数中并行搜索压缩效果最好的一组。
+    // samples 为首尾相接的样本数据，sizes 为各样本的长度；失败时 error 为 zstd 的错误信息
+    bool trainDictionary(const unsigned char* samples, const std::vector<size_t>& sizes, size_t maxDictSize,
+                         int level, int numThreads, std::vector<unsigned char>& dictionary, std::string& error);
+
+    // 进程内共享的字典注册表，按字典 ID 查找 DDict。字典文件只读映射（页面在进程间共享），
+    // DDict 按引用构建，不复制字典内容；注册后的字典在进程结束前一直有效，查找可在多线程中并发进行
+    class DictionaryRegistry {
+    public:
+        static DictionaryRegistry& instance();
+
+        // 返回字典 ID；文件无法映射、不是带 ID 的 zstd 字典时返回 0。同一 ID 重复注册时保留先注册的
+        unsigned add(const std::string& dictFile);
+        const ZSTD_DDict* find(unsigned dictID) const;
+        // 字典的映射内容，压缩时用来构建 CDict
+        bool content(unsigned dictID, const unsigned char*& data, size_t& size) const;
+        std::vector<unsigned> ids() const;
+
+    private:
+        struct Entry {
+            MappedFile file;
+            ZSTD_DDict* ddict = nullptr;
+            ~Entry();
+        };
+
+        DictionaryRegistry() = default;
+
+        mutable std::shared_mutex m_mutex;
+        std::unordered_map<unsigned, std::unique_ptr<Entry>> m_entries;
+    };
+
+    // 压缩字典缓存的键：字典 ID 加内容校验和确定字典内容，再加上压缩级别和是否使用专用字典搜索
+    struct CDictKey {
+        unsigned dictID = 0;
+        uint64_t checksum = 0;
+        int level = 0;
+        bool dedicatedSearch = false;
+
+        bool operator==(const CDictKey& other) const {
+            return dictID == other.dictID && checksum == other.checksum && level == other.level
+                && dedicatedSearch == other.dedicatedSearch;
+        }
+    };
+
+    struct CDictKeyHash {
+        size_t operator()(const CDictKey& key) const;
+    };
+
+    // 进程内共享的 CDict 缓存：同一字典在同一参数下只解析一次，所有实例和线程共用（CDict 只读，
+    // 可被多个 CCtx 同时引用）。缓存本身只弱引用 CDict，另外让最近使用的 kRecentEntries 个保持存活，
+    // 短生命周期的实例反复创建时不必重建；其余 CDict 随最后一个使用者释放，缓存不会无限增长
+    class CDictCache {
+    public:
+        static constexpr size_t kRecentEntries = 8;
+
+        static CDictCache& instance();
+
+        // persistent 表示 dict 的内存在进程结束前一直有效（例如注册表中映射的字典），此时 CDict
+        // 直接引用它，否则复制一份；失败返回空句柄
+        std::shared_ptr<const ZSTD_CDict> get(const unsigned char* dict, size_t size, uint64_t checksum,
+                                              int level, bool persistent);
+        // 释放缓存持有的 CDict，正在被实例使用的不受影响
+        void clear();
+        size_t size() const; // 仍然存活的 CDict 个数
+
+    private:
+        CDictCache() = default;
+        void touch(const std::shared_ptr<const ZSTD_CDict>& cdict); // 调用方持有锁
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<CDictKey, std::weak_ptr<const ZSTD_CDict>, CDictKeyHash> m_entries;
+        std::deque<std::shared_ptr<const ZSTD_CDict>> m_recent; // 最近使用的在前
+    };
+
+    // 字典内容的校验和，作为缓存键的一部分区分 ID 相同而内容不同的字典
+    uint64_t dictionaryChecksum(const unsigned char* dict, size_t size);
+
+    // 让 cctx 引用 cdict（nullptr 即回到无字典模式），引用时开启 CDict 表的预取；返回 zstd 的错误码
+    size_t referenceCDict(ZSTD_CCtx* cctx, const ZSTD_CDict* cdict);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // IMAGEDICTIONARY_H
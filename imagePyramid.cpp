@@ -0,0 +1,100 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "imagePyramid.h"
+#include "byteOrder.h"
+#include <zstd.h>
+#include <cstring>
+#include <utility>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr unsigned char kPyramidTag[4] = { 'Z', 'B', 'M', 'P' };
+constexpr unsigned char kPyramidVersion = 1;
+// 索引帧内容：标签(4) | 版本(1) | 保留(3) | LE32 层数 | 层表
+constexpr size_t kIndexHeaderSize = 12;
+constexpr size_t kIndexEntrySize = 32;   // LE32 层号 | LE32 宽 | LE32 高 | 保留(4) | LE64 偏移 | LE64 长度
+
+} // namespace
+
+const PyramidLevel* PyramidIndex::find(uint32_t level) const {
+    for (const PyramidLevel& entry : levels) {
+        if (entry.level == level) return &entry;
+    }
+    return nullptr;
+}
+
+size_t writePyramidIndex(const PyramidIndex& index, std::vector<unsigned char>& out) {
+    std::vector<unsigned char> body(kIndexHeaderSize + index.levels.size() * kIndexEntrySize, 0);
+    std::memcpy(body.data(), kPyramidTag, sizeof(kPyramidTag));
+    body[4] = kPyramidVersion;
+    writeLE32(body.data() + 8, static_cast<uint32_t>(index.levels.size()));
+
+    unsigned char* entry = body.data() + kIndexHeaderSize;
+    for (const PyramidLevel& level : index.levels) {
+        writeLE32(entry, level.level);
+        writeLE32(entry + 4, level.width);
+        writeLE32(entry + 8, level.height);
+        writeLE64(entry + 16, level.offset);
+        writeLE64(entry + 24, level.size);
+        entry += kIndexEntrySize;
+    }
+
+    const size_t offset = out.size();
+    out.resize(offset + kSkippableHeaderSize + body.size());
+    const size_t written = ZSTD_writeSkippableFrame(out.data() + offset, out.size() - offset,
+                                                    body.data(), body.size(), kPyramidIndexMagicVariant);
+    if (ZSTD_isError(written)) {
+        out.resize(offset);
+        return 0;
+    }
+    return written;
+}
+
+bool isImagePyramid(const unsigned char* src, size_t size) {
+    if (size < kSkippableHeaderSize + sizeof(kPyramidTag)) return false;
+    if (readLE32(src) != ZSTD_MAGIC_SKIPPABLE_START + kPyramidIndexMagicVariant) return false;
+    return std::memcmp(src + kSkippableHeaderSize, kPyramidTag, sizeof(kPyramidTag)) == 0;
+}
+
+size_t pyramidIndexSize(const unsigned char* header) {
+    if (readLE32(header) != ZSTD_MAGIC_SKIPPABLE_START + kPyramidIndexMagicVariant) return 0;
+    return kSkippableHeaderSize + readLE32(header + 4);
+}
+
+bool readPyramidIndex(const unsigned char* src, size_t size, uint64_t totalSize, PyramidIndex& index,
+                      size_t& indexSize) {
+    if (!isImagePyramid(src, size) || size < kSkippableHeaderSize + kIndexHeaderSize) return false;
+
+    const unsigned char* body = src + kSkippableHeaderSize;
+    const size_t bodySize = readLE32(src + 4);
+    if (body[4] != kPyramidVersion || bodySize > size - kSkippableHeaderSize) return false;
+    const size_t count = readLE32(body + 8);
+    if (bodySize != kIndexHeaderSize + count * kIndexEntrySize) return false;
+
+    const size_t frameSize = kSkippableHeaderSize + bodySize;
+    if (totalSize < frameSize) return false;
+    const uint64_t dataSize = totalSize - frameSize;
+
+    PyramidIndex parsed;
+    parsed.levels.resize(count);
+    const unsigned char* entry = body + kIndexHeaderSize;
+    for (size_t i = 0; i < count; ++i, entry += kIndexEntrySize) {
+        PyramidLevel& level = parsed.levels[i];
+        level.level = readLE32(entry);
+        level.width = readLE32(entry + 4);
+        level.height = readLE32(entry + 8);
+        level.offset = readLE64(entry + 16);
+        level.size = readLE64(entry + 24);
+        if (level.offset > dataSize || level.size > dataSize - level.offset) return false;
+    }
+    if (!parsed.find(0)) return false;
+
+    index = std::move(parsed);
+    indexSize = frameSize;
+    return true;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
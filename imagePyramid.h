@@ -0,0 +1,48 @@
+#ifndef IMAGEPYRAMID_H
+#define IMAGEPYRAMID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 金字塔索引使用的 zstd 可跳过帧编号（0x184D2A50 + 变体）
+    constexpr unsigned kPyramidIndexMagicVariant = 0xE;
+
+    // 金字塔的一层：level 0 为原图，第 k 层为原图缩小 2^k 倍；offset 从索引帧末尾算起（原图层可能超过 4GB）。
+    // 缩小的层是单个 RAW 帧，原图层可以是单个 RAW 帧或分块容器
+    struct PyramidLevel {
+        uint32_t level = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    // 各层按存储顺序排列：最粗的层在前，原图在最后，读取缩略图只需文件开头的几 KB
+    struct PyramidIndex {
+        std::vector<PyramidLevel> levels;
+
+        const PyramidLevel* find(uint32_t level) const;
+    };
+
+    // 将索引写成一个可跳过帧追加到 out，返回写入的字节数（失败返回 0）
+    size_t writePyramidIndex(const PyramidIndex& index, std::vector<unsigned char>& out);
+
+    // 判断数据是否以金字塔索引帧开始
+    bool isImagePyramid(const unsigned char* src, size_t size);
+
+    // 数据开头 8 字节（可跳过帧头）记录的索引帧长度，不是金字塔索引帧时返回 0
+    size_t pyramidIndexSize(const unsigned char* header);
+
+    // 解析金字塔索引帧（src 至少包含 size 字节的完整索引帧），totalSize 为索引帧加全部层数据的长度，
+    // 层位置超出 totalSize 或缺少原图层时返回 false；indexSize 返回索引帧长度
+    bool readPyramidIndex(const unsigned char* src, size_t size, uint64_t totalSize, PyramidIndex& index,
+                          size_t& indexSize);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // IMAGEPYRAMID_H
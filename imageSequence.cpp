@@ -0,0 +1,89 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "imageSequence.h"
+#include "byteOrder.h"
+#include <zstd.h>
+#include <cstring>
+#include <utility>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr unsigned char kSequenceTag[4] = { 'Z', 'B', 'M', 'S' };
+constexpr unsigned char kSequenceVersion = 1;
+// 索引帧内容：标签(4) | 版本(1) | 保留(3) | LE32 关键帧间隔 | LE32 帧数 | 帧表 | LE32 索引帧长度
+constexpr size_t kIndexHeaderSize = 16;
+constexpr size_t kIndexEntrySize = 16;   // LE64 偏移 | LE32 长度 | 标志(1) | 保留(3)
+constexpr size_t kIndexFooterSize = 4;
+constexpr unsigned char kFrameKeyframe = 1;
+
+} // namespace
+
+size_t writeSequenceIndex(const SequenceIndex& index, std::vector<unsigned char>& out) {
+    const size_t bodySize = kIndexHeaderSize + index.frames.size() * kIndexEntrySize + kIndexFooterSize;
+    std::vector<unsigned char> body(bodySize, 0);
+    std::memcpy(body.data(), kSequenceTag, sizeof(kSequenceTag));
+    body[4] = kSequenceVersion;
+    writeLE32(body.data() + 8, index.keyframeInterval);
+    writeLE32(body.data() + 12, static_cast<uint32_t>(index.frames.size()));
+
+    unsigned char* entry = body.data() + kIndexHeaderSize;
+    for (const SequenceFrame& frame : index.frames) {
+        writeLE64(entry, frame.offset);
+        writeLE32(entry + 8, frame.size);
+        entry[12] = frame.keyframe ? kFrameKeyframe : 0;
+        entry += kIndexEntrySize;
+    }
+    writeLE32(entry, static_cast<uint32_t>(kSkippableHeaderSize + bodySize));
+
+    const size_t offset = out.size();
+    out.resize(offset + kSkippableHeaderSize + bodySize);
+    const size_t written = ZSTD_writeSkippableFrame(out.data() + offset, out.size() - offset,
+                                                    body.data(), body.size(), kSequenceIndexMagicVariant);
+    if (ZSTD_isError(written)) {
+        out.resize(offset);
+        return 0;
+    }
+    return written;
+}
+
+size_t sequenceIndexSize(const unsigned char* footer) {
+    return readLE32(footer);
+}
+
+bool readSequenceIndex(const unsigned char* src, size_t size, uint64_t dataEnd, SequenceIndex& index) {
+    if (size < kSkippableHeaderSize + kIndexHeaderSize + kIndexFooterSize) return false;
+    if (readLE32(src) != ZSTD_MAGIC_SKIPPABLE_START + kSequenceIndexMagicVariant) return false;
+    if (readLE32(src + 4) != size - kSkippableHeaderSize) return false;
+
+    const unsigned char* body = src + kSkippableHeaderSize;
+    if (std::memcmp(body, kSequenceTag, sizeof(kSequenceTag)) != 0 || body[4] != kSequenceVersion) return false;
+    const size_t count = readLE32(body + 12);
+    if (size != kSkippableHeaderSize + kIndexHeaderSize + count * kIndexEntrySize + kIndexFooterSize) return false;
+
+    SequenceIndex parsed;
+    parsed.keyframeInterval = readLE32(body + 8);
+    parsed.frames.resize(count);
+    const unsigned char* entry = body + kIndexHeaderSize;
+    for (size_t i = 0; i < count; ++i, entry += kIndexEntrySize) {
+        SequenceFrame& frame = parsed.frames[i];
+        frame.offset = readLE64(entry);
+        frame.size = readLE32(entry + 8);
+        frame.keyframe = (entry[12] & kFrameKeyframe) != 0;
+        if (frame.offset > dataEnd || frame.size > dataEnd - frame.offset) return false;
+    }
+    // 第一帧必须是关键帧，否则任何帧都无法解码
+    if (count > 0 && !parsed.frames[0].keyframe) return false;
+
+    index = std::move(parsed);
+    return true;
+}
+
+size_t nearestKeyframe(const SequenceIndex& index, size_t frame) {
+    while (frame > 0 && !index.frames[frame].keyframe) --frame;
+    return frame;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,42 @@
+#ifndef IMAGESEQUENCE_H
+#define IMAGESEQUENCE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 序列索引使用的 zstd 可跳过帧编号（0x184D2A50 + 变体）
+    constexpr unsigned kSequenceIndexMagicVariant = 0xC;
+
+    // 序列中的一帧：offset / size 为该帧（RAW 头部 + zstd 帧）在文件中的位置，
+    // 非关键帧保存与上一帧解码结果的逐样本差分（8 位按字节、16 位按样本取模）
+    struct SequenceFrame {
+        uint64_t offset = 0;
+        uint32_t size = 0;
+        bool keyframe = false;
+    };
+
+    struct SequenceIndex {
+        uint32_t keyframeInterval = 0;
+        std::vector<SequenceFrame> frames;
+    };
+
+    // 索引写成一个可跳过帧追加到文件末尾，帧的最后 4 字节为整个索引帧的长度，便于从文件尾定位
+    size_t writeSequenceIndex(const SequenceIndex& index, std::vector<unsigned char>& out);
+
+    // 文件最后 4 字节记录的索引帧长度
+    size_t sequenceIndexSize(const unsigned char* footer);
+
+    // 解析位于文件末尾的索引帧（src 指向索引帧开头），帧位置超出 dataEnd 时返回 false
+    bool readSequenceIndex(const unsigned char* src, size_t size, uint64_t dataEnd, SequenceIndex& index);
+
+    // 解码第 frame 帧需要从哪一帧开始（不晚于它的最近关键帧）
+    size_t nearestKeyframe(const SequenceIndex& index, size_t frame);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // IMAGESEQUENCE_H
@@ -0,0 +1,131 @@
+#include "imageSimilarity.h"
+#include <algorithm>
+#include <bitset>
+#include <cmath>
+
+extern "C" {
+#include "hist.h"
+}
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr size_t kHashGrid = 8;
+constexpr size_t kMaxHashSamples = 256; // 每个方向最多采样的像素数，大图不必逐像素累加
+constexpr float kLayoutPenalty = 0.25f;
+
+// 累加一段数据的字节直方图
+void addHistogram(const uint8_t* src, size_t size, unsigned* total) {
+    if (size == 0) return;
+    unsigned counts[256];
+    unsigned maxSymbol = 255;
+    if (HIST_isError(HIST_count(counts, &maxSymbol, src, size))) return;
+    for (unsigned v = 0; v <= maxSymbol; ++v) total[v] += counts[v];
+}
+
+void normalizeHistogram(const unsigned* total, ImageSignature& out) {
+    uint64_t sum = 0;
+    for (size_t v = 0; v < 256; ++v) sum += total[v];
+    std::fill(out.histogram, out.histogram + kSignatureBins, 0.0f);
+    if (sum == 0) return;
+    const size_t binWidth = 256 / kSignatureBins;
+    for (size_t v = 0; v < 256; ++v) out.histogram[v / binWidth] += static_cast<float>(total[v]);
+    for (float& bin : out.histogram) bin /= static_cast<float>(sum);
+}
+
+} // namespace
+
+void imageSignature(const uint8_t* pixels, size_t stride, size_t width, size_t rows, size_t bpp,
+                    ImageSignature& out) {
+    out = ImageSignature();
+    out.width = static_cast<uint32_t>(width);
+    out.height = static_cast<uint32_t>(rows);
+    out.bpp = static_cast<uint32_t>(bpp);
+    if (width == 0 || rows == 0 || bpp == 0) return;
+
+    unsigned total[256] = {};
+    const size_t rowBytes = width * bpp;
+    if (stride == rowBytes) {
+        addHistogram(pixels, rowBytes * rows, total);
+    } else {
+        for (size_t y = 0; y < rows; ++y) addHistogram(pixels + y * stride, rowBytes, total);
+    }
+    normalizeHistogram(total, out);
+
+    // 均值哈希：8x8 网格内的平均亮度（每像素各字节的平均）与全图平均比较
+    double cells[kHashGrid * kHashGrid] = {};
+    size_t samples[kHashGrid * kHashGrid] = {};
+    const size_t stepY = std::max<size_t>(1, rows / kMaxHashSamples);
+    const size_t stepX = std::max<size_t>(1, width / kMaxHashSamples);
+    for (size_t y = 0; y < rows; y += stepY) {
+        const uint8_t* row = pixels + y * stride;
+        const size_t cy = y * kHashGrid / rows;
+        for (size_t x = 0; x < width; x += stepX) {
+            unsigned value = 0;
+            for (size_t c = 0; c < bpp; ++c) value += row[x * bpp + c];
+            const size_t cell = cy * kHashGrid + x * kHashGrid / width;
+            cells[cell] += static_cast<double>(value) / bpp;
+            ++samples[cell];
+        }
+    }
+    double mean = 0.0;
+    size_t used = 0;
+    for (size_t i = 0; i < kHashGrid * kHashGrid; ++i) {
+        if (samples[i] == 0) continue;
+        cells[i] /= static_cast<double>(samples[i]);
+        mean += cells[i];
+        ++used;
+    }
+    mean /= static_cast<double>(std::max<size_t>(used, 1));
+    for (size_t i = 0; i < kHashGrid * kHashGrid; ++i) {
+        if (samples[i] != 0 && cells[i] > mean) out.hash |= uint64_t(1) << i;
+    }
+}
+
+void dataSignature(const uint8_t* data, size_t size, ImageSignature& out) {
+    out = ImageSignature();
+    unsigned total[256] = {};
+    addHistogram(data, size, total);
+    normalizeHistogram(total, out);
+}
+
+float signatureDistance(const ImageSignature& a, const ImageSignature& b) {
+    float histogram = 0.0f;
+    for (size_t i = 0; i < kSignatureBins; ++i) histogram += std::fabs(a.histogram[i] - b.histogram[i]);
+    histogram *= 0.5f;
+
+    float distance = histogram;
+    if (a.bpp != 0 && b.bpp != 0) {
+        const float hash = static_cast<float>(std::bitset<64>(a.hash ^ b.hash).count()) / 64.0f;
+        distance = 0.5f * (histogram + hash);
+    }
+    if (a.width != b.width || a.height != b.height || a.bpp != b.bpp) distance += kLayoutPenalty;
+    return std::min(distance, 1.0f);
+}
+
+std::vector<std::vector<size_t>> clusterSignatures(const std::vector<ImageSignature>& signatures, float threshold) {
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<size_t> leaders;
+    for (size_t i = 0; i < signatures.size(); ++i) {
+        size_t cluster = leaders.size();
+        float best = threshold;
+        for (size_t k = 0; k < leaders.size(); ++k) {
+            const float distance = signatureDistance(signatures[leaders[k]], signatures[i]);
+            if (distance <= best) {
+                best = distance;
+                cluster = k;
+            }
+        }
+        if (cluster == leaders.size()) {
+            leaders.push_back(i);
+            clusters.emplace_back();
+        }
+        clusters[cluster].push_back(i);
+    }
+    return clusters;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,40 @@
+#ifndef IMAGESIMILARITY_H
+#define IMAGESIMILARITY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    constexpr size_t kSignatureBins = 64;
+
+    // 图像的廉价签名：字节直方图（每 4 个字节值合并为一格，归一化到和为 1）+ 8x8 均值哈希。
+    // bpp 为 0 表示只有直方图（数据无法解码为像素）
+    struct ImageSignature {
+        float histogram[kSignatureBins] = {};
+        uint64_t hash = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t bpp = 0;
+    };
+
+    // 像素签名，bpp 为每像素字节数；哈希取每像素各字节的平均值
+    void imageSignature(const uint8_t* pixels, size_t stride, size_t width, size_t rows, size_t bpp,
+                        ImageSignature& out);
+
+    // 只根据数据字节计算直方图（例如 PNG / JPEG 文件）
+    void dataSignature(const uint8_t* data, size_t size, ImageSignature& out);
+
+    // 签名距离，0 为相同，1 为完全不同；尺寸或像素字节数不同的图像额外加一段距离
+    float signatureDistance(const ImageSignature& a, const ImageSignature& b);
+
+    // 领头聚类：按输入顺序，每个签名归入与簇首距离最近且不超过 threshold 的簇，否则自成一簇。
+    // 返回各簇的成员序号，簇按创建顺序排列，簇内保持输入顺序
+    std::vector<std::vector<size_t>> clusterSignatures(const std::vector<ImageSignature>& signatures, float threshold);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // IMAGESIMILARITY_H
@@ -0,0 +1,38 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 只读内存映射文件：页面由操作系统按需读入并在进程间共享，不复制到进程堆
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& filename);
+        void close();
+
+        const unsigned char* data() const { return m_data; }
+        size_t size() const { return m_size; }
+        bool isOpen() const { return m_data != nullptr; }
+
+    private:
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_file = nullptr;
+        void* m_mapping = nullptr;
+#endif
+    };
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // MAPPEDFILE_H
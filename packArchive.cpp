@@ -0,0 +1,183 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "packArchive.h"
+#include "byteOrder.h"
+#include <zstd.h>
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash.h"
+#include <cstring>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr unsigned char kPackTag[4] = { 'Z', 'B', 'M', 'K' };
+constexpr unsigned char kPackVersion = 2;
+constexpr unsigned char kPackVersionV1 = 1; // 无固实块字段的旧版本，仍可读取
+// 索引帧内容：标签(4) | 版本(1) | 保留(3) | LE32 条目数 | LE32 桶数（2 的幂）| LE32 名字区长度
+//           | 桶表（LE32 条目序号 + 1，0 为空）| 条目表 | 名字区 | LE32 索引帧长度
+constexpr size_t kIndexHeaderSize = 20;
+constexpr size_t kBucketSize = 4;
+// LE64 偏移 | LE64 长度 | LE64 校验和 | LE32 字典 ID | LE32 名字偏移 | LE32 名字长度 | 保留(4)
+// | LE64 块内偏移 | LE64 块内长度（版本 1 没有最后两项）
+constexpr size_t kIndexEntrySize = 56;
+constexpr size_t kIndexEntrySizeV1 = 40;
+constexpr size_t kIndexFooterSize = 4;
+
+uint64_t nameHash(const char* name, size_t length) {
+    return XXH64(name, length, 0);
+}
+
+// 桶数取不小于 2 倍条目数的 2 的幂，装载率不超过 1/2
+size_t bucketCount(size_t entries) {
+    size_t buckets = 16;
+    while (buckets < entries * 2) buckets <<= 1;
+    return buckets;
+}
+
+} // namespace
+
+uint64_t packChecksum(const unsigned char* src, size_t size) {
+    return XXH64(src, size, 0);
+}
+
+uint32_t frameDictID(const unsigned char* src, size_t size) {
+    while (size > 0) {
+        const size_t frameSize = ZSTD_findFrameCompressedSize(src, size);
+        if (ZSTD_isError(frameSize) || frameSize > size) return 0;
+        if (!ZSTD_isSkippableFrame(src, size)) return ZSTD_getDictID_fromFrame(src, size);
+        src += frameSize;
+        size -= frameSize;
+    }
+    return 0;
+}
+
+size_t writePackIndex(const std::vector<PackEntry>& entries, std::vector<unsigned char>& out) {
+    size_t namesSize = 0;
+    for (const PackEntry& entry : entries) namesSize += entry.name.size();
+    const size_t buckets = bucketCount(entries.size());
+    const size_t bodySize = kIndexHeaderSize + buckets * kBucketSize + entries.size() * kIndexEntrySize
+                          + namesSize + kIndexFooterSize;
+    if (bodySize + kSkippableHeaderSize > UINT32_MAX) return 0;
+
+    std::vector<unsigned char> body(bodySize, 0);
+    std::memcpy(body.data(), kPackTag, sizeof(kPackTag));
+    body[4] = kPackVersion;
+    writeLE32(body.data() + 8, static_cast<uint32_t>(entries.size()));
+    writeLE32(body.data() + 12, static_cast<uint32_t>(buckets));
+    writeLE32(body.data() + 16, static_cast<uint32_t>(namesSize));
+
+    unsigned char* bucketTable = body.data() + kIndexHeaderSize;
+    unsigned char* entry = bucketTable + buckets * kBucketSize;
+    unsigned char* names = entry + entries.size() * kIndexEntrySize;
+    size_t nameOffset = 0;
+    for (size_t i = 0; i < entries.size(); ++i, entry += kIndexEntrySize) {
+        const PackEntry& e = entries[i];
+        writeLE64(entry, e.offset);
+        writeLE64(entry + 8, e.size);
+        writeLE64(entry + 16, e.checksum);
+        writeLE32(entry + 24, e.dictID);
+        writeLE32(entry + 28, static_cast<uint32_t>(nameOffset));
+        writeLE32(entry + 32, static_cast<uint32_t>(e.name.size()));
+        writeLE64(entry + 40, e.memberOffset);
+        writeLE64(entry + 48, e.memberSize);
+        std::memcpy(names + nameOffset, e.name.data(), e.name.size());
+        nameOffset += e.name.size();
+
+        // 线性探测；同名条目保留先写入的一个
+        size_t bucket = nameHash(e.name.data(), e.name.size()) & (buckets - 1);
+        while (readLE32(bucketTable + bucket * kBucketSize) != 0) bucket = (bucket + 1) & (buckets - 1);
+        writeLE32(bucketTable + bucket * kBucketSize, static_cast<uint32_t>(i + 1));
+    }
+    writeLE32(body.data() + bodySize - kIndexFooterSize, static_cast<uint32_t>(kSkippableHeaderSize + bodySize));
+
+    const size_t offset = out.size();
+    out.resize(offset + kSkippableHeaderSize + bodySize);
+    const size_t written = ZSTD_writeSkippableFrame(out.data() + offset, out.size() - offset,
+                                                    body.data(), body.size(), kPackIndexMagicVariant);
+    if (ZSTD_isError(written)) {
+        out.resize(offset);
+        return 0;
+    }
+    return written;
+}
+
+bool PackIndex::open(const unsigned char* data, size_t size) {
+    *this = PackIndex();
+    if (size < kSkippableHeaderSize + kIndexHeaderSize + kIndexFooterSize) return false;
+    const size_t frameSize = readLE32(data + size - kIndexFooterSize);
+    if (frameSize < kSkippableHeaderSize + kIndexHeaderSize + kIndexFooterSize || frameSize > size) return false;
+
+    const unsigned char* frame = data + size - frameSize;
+    if (readLE32(frame) != ZSTD_MAGIC_SKIPPABLE_START + kPackIndexMagicVariant) return false;
+    if (readLE32(frame + 4) != frameSize - kSkippableHeaderSize) return false;
+    const unsigned char* body = frame + kSkippableHeaderSize;
+    if (std::memcmp(body, kPackTag, sizeof(kPackTag)) != 0) return false;
+    if (body[4] != kPackVersion && body[4] != kPackVersionV1) return false;
+    const size_t entrySize = body[4] == kPackVersionV1 ? kIndexEntrySizeV1 : kIndexEntrySize;
+
+    const size_t count = readLE32(body + 8);
+    const size_t buckets = readLE32(body + 12);
+    const size_t namesSize = readLE32(body + 16);
+    if (buckets == 0 || (buckets & (buckets - 1)) != 0 || buckets < count) return false;
+    if (frameSize != kSkippableHeaderSize + kIndexHeaderSize + buckets * kBucketSize + count * entrySize
+                     + namesSize + kIndexFooterSize) return false;
+
+    m_data = data;
+    m_dataSize = size - frameSize;
+    m_buckets = body + kIndexHeaderSize;
+    m_entries = m_buckets + buckets * kBucketSize;
+    m_entrySize = entrySize;
+    m_names = m_entries + count * entrySize;
+    m_namesSize = namesSize;
+    m_count = count;
+    m_bucketMask = buckets - 1;
+    return true;
+}
+
+bool PackIndex::entry(size_t i, PackEntry& out) const {
+    if (i >= m_count) return false;
+    const unsigned char* e = m_entries + i * m_entrySize;
+    const uint64_t offset = readLE64(e);
+    const uint64_t size = readLE64(e + 8);
+    const size_t nameOffset = readLE32(e + 28);
+    const size_t nameLength = readLE32(e + 32);
+    const bool solidFields = m_entrySize >= kIndexEntrySize;
+    const uint64_t memberOffset = solidFields ? readLE64(e + 40) : 0;
+    const uint64_t memberSize = solidFields ? readLE64(e + 48) : 0;
+    if (offset > m_dataSize || size > m_dataSize - offset) return false;
+    if (nameOffset > m_namesSize || nameLength > m_namesSize - nameOffset) return false;
+    // 块内范围要等解压后才能与块长度比较，这里只排除溢出
+    if (memberOffset > UINT64_MAX - memberSize) return false;
+
+    out.name.assign(reinterpret_cast<const char*>(m_names + nameOffset), nameLength);
+    out.offset = offset;
+    out.size = size;
+    out.checksum = readLE64(e + 16);
+    out.dictID = readLE32(e + 24);
+    out.memberOffset = memberOffset;
+    out.memberSize = memberSize;
+    return true;
+}
+
+bool PackIndex::find(const std::string& name, PackEntry& out) const {
+    if (m_count == 0) return false;
+    size_t bucket = nameHash(name.data(), name.size()) & m_bucketMask;
+    // 至多探测整张表一次，防止损坏的索引造成死循环
+    for (size_t probe = 0; probe <= m_bucketMask; ++probe, bucket = (bucket + 1) & m_bucketMask) {
+        const size_t slot = readLE32(m_buckets + bucket * kBucketSize);
+        if (slot == 0) return false;
+        if (slot > m_count) return false;
+        const unsigned char* e = m_entries + (slot - 1) * m_entrySize;
+        const size_t nameOffset = readLE32(e + 28);
+        const size_t nameLength = readLE32(e + 32);
+        if (nameLength == name.size() && nameOffset <= m_namesSize && nameLength <= m_namesSize - nameOffset
+            && std::memcmp(m_names + nameOffset, name.data(), nameLength) == 0) {
+            return entry(slot - 1, out);
+        }
+    }
+    return false;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
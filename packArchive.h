@@ -0,0 +1,77 @@
+#ifndef PACKARCHIVE_H
+#define PACKARCHIVE_H
+
+#include "mappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 打包文件索引使用的 zstd 可跳过帧编号（0x184D2A50 + 变体）
+    constexpr unsigned kPackIndexMagicVariant = 0xF;
+
+    // 包中的一个条目：offset / size 为压缩数据在文件中的位置，checksum 为压缩数据的 XXH64，
+    // dictID 为数据中第一个 zstd 帧使用的字典（0 表示不使用字典）。
+    // 固实条目与同组的其他图像共用 offset / size 处的一个 zstd 帧，memberOffset / memberSize
+    // 为其在解压后的块中的位置，此时 checksum 为成员数据（解压后）的 XXH64
+    struct PackEntry {
+        std::string name;
+        uint64_t offset = 0;
+        uint64_t size = 0;
+        uint64_t checksum = 0;
+        uint32_t dictID = 0;
+        uint64_t memberOffset = 0;
+        uint64_t memberSize = 0; // 0 表示非固实条目
+
+        bool solid() const { return memberSize != 0; }
+    };
+
+    // 压缩数据的校验和
+    uint64_t packChecksum(const unsigned char* src, size_t size);
+
+    // 数据中第一个 zstd 帧（跳过开头的可跳过帧）使用的字典 ID
+    uint32_t frameDictID(const unsigned char* src, size_t size);
+
+    // 把索引（按名字哈希的开放寻址表 + 条目表 + 名字区）写成一个可跳过帧追加到 out，
+    // 帧的最后 4 字节为整个索引帧的长度，便于从文件尾定位；失败返回 0
+    size_t writePackIndex(const std::vector<PackEntry>& entries, std::vector<unsigned char>& out);
+
+    // 直接在映射内存上查找的只读索引：打开时只检查表的尺寸，条目在访问时才校验边界
+    class PackIndex {
+    public:
+        // data 为整个包文件的内容
+        bool open(const unsigned char* data, size_t size);
+
+        size_t count() const { return m_count; }
+        // 第 i 个条目（按写入顺序），条目越界时返回 false
+        bool entry(size_t i, PackEntry& out) const;
+        // 按名字查找，平均 O(1)
+        bool find(const std::string& name, PackEntry& out) const;
+
+    private:
+        const unsigned char* m_data = nullptr;
+        uint64_t m_dataSize = 0;     // 条目数据区（索引帧之前）的长度
+        const unsigned char* m_buckets = nullptr;
+        const unsigned char* m_entries = nullptr;
+        size_t m_entrySize = 0;      // 条目表每项的字节数，随索引版本而不同
+        const unsigned char* m_names = nullptr;
+        size_t m_namesSize = 0;
+        size_t m_count = 0;
+        size_t m_bucketMask = 0;
+    };
+
+    // 映射的包文件及其索引；block 缓存最近解压的固实块，连续读取同一块的成员时不再重复解压
+    struct PackReader {
+        MappedFile file;
+        PackIndex index;
+        std::vector<unsigned char> block;
+        uint64_t blockOffset = UINT64_MAX; // block 对应的块在文件中的偏移，UINT64_MAX 表示无缓存
+    };
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PACKARCHIVE_H
@@ -0,0 +1,368 @@
+#include "pixelFilter.h"
+#include "pixelSimd.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "hist.h"
+}
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+inline uint8_t paethPredictor(int a, int b, int c) {
+    const int pa = std::abs(b - c);
+    const int pb = std::abs(a - c);
+    const int pc = std::abs(a + b - 2 * c);
+    if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+// 无分支版本，供反滤波的串行循环使用（分支预测失败代价远高于计算）
+inline uint8_t paethPredictorBranchless(int a, int b, int c) {
+    const int pa = std::abs(b - c);
+    const int pb = std::abs(a - c);
+    const int pc = std::abs(a + b - 2 * c);
+    const int selA = -static_cast<int>((pa <= pb) & (pa <= pc));
+    const int selB = -static_cast<int>(pb <= pc);
+    const int bc = (b & selB) | (c & ~selB);
+    return static_cast<uint8_t>((a & selA) | (bc & ~selA));
+}
+
+// 固定像素宽度的反滤波：左侧像素保存在寄存器中，避免逐字节的读后写依赖
+template <size_t Bpp, FilterType Type>
+void unfilterPixels(const uint8_t* in, const uint8_t* prev, size_t rowBytes, uint8_t* out) {
+    uint8_t a[Bpp] = {};
+    uint8_t c[Bpp] = {};
+    for (size_t i = 0; i + Bpp <= rowBytes; i += Bpp) {
+        for (size_t k = 0; k < Bpp; ++k) {
+            uint8_t pred;
+            if (Type == FilterType::Sub) {
+                pred = a[k];
+            } else if (Type == FilterType::Average) {
+                pred = static_cast<uint8_t>((a[k] + prev[i + k]) >> 1);
+            } else {
+                const uint8_t b = prev[i + k];
+                pred = paethPredictorBranchless(a[k], b, c[k]);
+                c[k] = b;
+            }
+            a[k] = static_cast<uint8_t>(in[i + k] + pred);
+            out[i + k] = a[k];
+        }
+    }
+}
+
+template <size_t Bpp>
+void unfilterPixels(FilterType type, const uint8_t* in, const uint8_t* prev, size_t rowBytes, uint8_t* out) {
+    switch (type) {
+        case FilterType::Sub: unfilterPixels<Bpp, FilterType::Sub>(in, prev, rowBytes, out); break;
+        case FilterType::Average: unfilterPixels<Bpp, FilterType::Average>(in, prev, rowBytes, out); break;
+        default: unfilterPixels<Bpp, FilterType::Paeth>(in, prev, rowBytes, out); break;
+    }
+}
+
+// 用 zstd 的字节直方图估计 0 阶熵（比特数），作为滤波结果可压缩性的代理。
+// bits = N*log2(N) - sum(c*log2(c))，c*log2(c) 查表，size 不得超过表长
+double entropyBits(const uint8_t* data, size_t size, const std::vector<double>& cLog2c) {
+    // 抽样块只有几 KB，直接用单表计数（HIST_count 的并行版本需要先清空 4KB 工作区）
+    unsigned counts[256];
+    unsigned maxSymbol = 255;
+    HIST_count_simple(counts, &maxSymbol, data, size);
+    double bits = cLog2c[size];
+    for (unsigned s = 0; s <= maxSymbol; ++s) bits -= cLog2c[counts[s]];
+    return bits;
+}
+
+#if BMP_HAVE_SSE2
+inline __m128i loadu(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void storeu(uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+// floor((a + b) / 2)，_mm_avg_epu8 是向上取整
+inline __m128i avgFloor(__m128i a, __m128i b) {
+    return _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), _mm_set1_epi8(1)));
+}
+
+inline __m128i abs16(__m128i x) {
+    return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+// 16 位通道上的 Paeth 预测
+inline __m128i paeth16(__m128i a, __m128i b, __m128i c) {
+    const __m128i pa = abs16(_mm_sub_epi16(b, c));
+    const __m128i pb = abs16(_mm_sub_epi16(a, c));
+    const __m128i pc = abs16(_mm_sub_epi16(_mm_add_epi16(a, b), _mm_add_epi16(c, c)));
+    const __m128i notA = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+    const __m128i notB = _mm_cmpgt_epi16(pb, pc);
+    const __m128i bc = _mm_or_si128(_mm_andnot_si128(notB, b), _mm_and_si128(notB, c));
+    return _mm_or_si128(_mm_andnot_si128(notA, a), _mm_and_si128(notA, bc));
+}
+
+inline __m128i paeth8(__m128i a, __m128i b, __m128i c) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = paeth16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero), _mm_unpacklo_epi8(c, zero));
+    const __m128i hi = paeth16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero), _mm_unpackhi_epi8(c, zero));
+    return _mm_packus_epi16(lo, hi);
+}
+#endif
+
+} // namespace
+
+void filterRow(FilterType type, const uint8_t* cur, const uint8_t* prev,
+               size_t rowBytes, size_t bpp, uint8_t* out) {
+    const size_t head = bpp < rowBytes ? bpp : rowBytes;
+    size_t i = 0;
+
+    switch (type) {
+        case FilterType::None:
+            std::memcpy(out, cur, rowBytes);
+            return;
+
+        case FilterType::Sub:
+            std::memcpy(out, cur, head);
+            i = head;
+#if BMP_HAVE_SSE2
+            for (; i + 16 <= rowBytes; i += 16) {
+                storeu(out + i, _mm_sub_epi8(loadu(cur + i), loadu(cur + i - bpp)));
+            }
+#endif
+            for (; i < rowBytes; ++i) out[i] = static_cast<uint8_t>(cur[i] - cur[i - bpp]);
+            return;
+
+        case FilterType::Up:
+#if BMP_HAVE_SSE2
+            for (; i + 16 <= rowBytes; i += 16) {
+                storeu(out + i, _mm_sub_epi8(loadu(cur + i), loadu(prev + i)));
+            }
+#endif
+            for (; i < rowBytes; ++i) out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+            return;
+
+        case FilterType::Average:
+            for (; i < head; ++i) out[i] = static_cast<uint8_t>(cur[i] - (prev[i] >> 1));
+#if BMP_HAVE_SSE2
+            for (; i + 16 <= rowBytes; i += 16) {
+                storeu(out + i, _mm_sub_epi8(loadu(cur + i), avgFloor(loadu(cur + i - bpp), loadu(prev + i))));
+            }
+#endif
+            for (; i < rowBytes; ++i) {
+                out[i] = static_cast<uint8_t>(cur[i] - ((cur[i - bpp] + prev[i]) >> 1));
+            }
+            return;
+
+        case FilterType::Paeth:
+            // 行首左侧和左上为 0，Paeth 退化为 Up
+            for (; i < head; ++i) out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+#if BMP_HAVE_SSE2
+            for (; i + 16 <= rowBytes; i += 16) {
+                const __m128i pred = paeth8(loadu(cur + i - bpp), loadu(prev + i), loadu(prev + i - bpp));
+                storeu(out + i, _mm_sub_epi8(loadu(cur + i), pred));
+            }
+#endif
+            for (; i < rowBytes; ++i) {
+                out[i] = static_cast<uint8_t>(cur[i] - paethPredictor(cur[i - bpp], prev[i], prev[i - bpp]));
+            }
+            return;
+    }
+}
+
+void unfilterRow(FilterType type, const uint8_t* in, const uint8_t* prev,
+                 size_t rowBytes, size_t bpp, uint8_t* out) {
+    const size_t head = bpp < rowBytes ? bpp : rowBytes;
+    size_t i = 0;
+
+    switch (type) {
+        case FilterType::None:
+            std::memcpy(out, in, rowBytes);
+            return;
+
+        case FilterType::Up:
+#if BMP_HAVE_SSE2
+            for (; i + 16 <= rowBytes; i += 16) {
+                storeu(out + i, _mm_add_epi8(loadu(in + i), loadu(prev + i)));
+            }
+#endif
+            for (; i < rowBytes; ++i) out[i] = static_cast<uint8_t>(in[i] + prev[i]);
+            return;
+
+        default:
+            break;
+    }
+
+    switch (rowBytes % bpp == 0 ? bpp : 0) {
+        case 1: unfilterPixels<1>(type, in, prev, rowBytes, out); return;
+        case 2: unfilterPixels<2>(type, in, prev, rowBytes, out); return;
+        case 3: unfilterPixels<3>(type, in, prev, rowBytes, out); return;
+        case 4: unfilterPixels<4>(type, in, prev, rowBytes, out); return;
+        default: break;
+    }
+
+    switch (type) {
+        case FilterType::Sub:
+            std::memcpy(out, in, head);
+            for (i = head; i < rowBytes; ++i) out[i] = static_cast<uint8_t>(in[i] + out[i - bpp]);
+            return;
+
+        case FilterType::Average:
+            for (; i < head; ++i) out[i] = static_cast<uint8_t>(in[i] + (prev[i] >> 1));
+            for (; i < rowBytes; ++i) {
+                out[i] = static_cast<uint8_t>(in[i] + ((out[i - bpp] + prev[i]) >> 1));
+            }
+            return;
+
+        default:
+            for (; i < head; ++i) out[i] = static_cast<uint8_t>(in[i] + prev[i]);
+            for (; i < rowBytes; ++i) {
+                out[i] = static_cast<uint8_t>(in[i] + paethPredictor(out[i - bpp], prev[i], prev[i - bpp]));
+            }
+            return;
+    }
+}
+
+uint64_t filterCost(const uint8_t* data, size_t size) {
+    uint64_t cost = 0;
+    size_t i = 0;
+#if BMP_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i acc = zero;
+    for (; i + 16 <= size; i += 16) {
+        const __m128i x = loadu(data + i);
+        // min(x, 256 - x) 即有符号字节的绝对值
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_min_epu8(x, _mm_sub_epi8(zero, x)), zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    cost = lanes[0] + lanes[1];
+#endif
+    for (; i < size; ++i) {
+        const int v = static_cast<int8_t>(data[i]);
+        cost += static_cast<uint64_t>(v < 0 ? -v : v);
+    }
+    return cost;
+}
+
+void filterRows(const uint8_t* src, size_t srcStride, size_t rows, size_t rowBytes, size_t bpp,
+                uint8_t* dst) {
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+    std::vector<uint8_t> trial(rowBytes);
+    std::vector<uint8_t> best(rowBytes);
+
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* cur = src + y * srcStride;
+        const uint8_t* prev = y > 0 ? cur - srcStride : zeroRow.data();
+        uint8_t* out = dst + y * (rowBytes + 1);
+
+        FilterType bestType = FilterType::None;
+        uint64_t bestCost = filterCost(cur, rowBytes);
+        for (uint8_t t = 1; t < kFilterTypeCount && bestCost > 0; ++t) {
+            const auto type = static_cast<FilterType>(t);
+            filterRow(type, cur, prev, rowBytes, bpp, trial.data());
+            const uint64_t cost = filterCost(trial.data(), rowBytes);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestType = type;
+                trial.swap(best);
+            }
+        }
+
+        out[0] = static_cast<uint8_t>(bestType);
+        std::memcpy(out + 1, bestType == FilterType::None ? cur : best.data(), rowBytes);
+    }
+}
+
+size_t tileCount(size_t rows, size_t rowBytes, size_t tileBytes, size_t tileRows) {
+    return ((rows + tileRows - 1) / tileRows) * ((rowBytes + tileBytes - 1) / tileBytes);
+}
+
+void filterTiles(const uint8_t* src, size_t srcStride, size_t rows, size_t rowBytes, size_t bpp,
+                 size_t tileBytes, size_t tileRows, uint8_t* map, uint8_t* dst) {
+    // 每块只抽样约 kSampleRows 行参与评估，选择开销与块高度无关
+    constexpr size_t kSampleRows = 8;
+    const size_t sampleStep = tileRows > kSampleRows ? tileRows / kSampleRows : 1;
+    const size_t tilesX = (rowBytes + tileBytes - 1) / tileBytes;
+
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+    const size_t sampleSize = ((tileRows + sampleStep - 1) / sampleStep) * tileBytes;
+    std::vector<uint8_t> sample(sampleSize);
+    std::vector<double> cLog2c(sampleSize + 1, 0.0);
+    for (size_t c = 2; c <= sampleSize; ++c) cLog2c[c] = c * std::log2(static_cast<double>(c));
+
+    for (size_t ty = 0; ty * tileRows < rows; ++ty) {
+        const size_t y0 = ty * tileRows;
+        const size_t y1 = y0 + tileRows < rows ? y0 + tileRows : rows;
+        for (size_t tx = 0; tx < tilesX; ++tx) {
+            const size_t x0 = tx * tileBytes;
+            const size_t width = x0 + tileBytes < rowBytes ? tileBytes : rowBytes - x0;
+
+            // 各候选滤波器在抽样行上的熵估计，取最小者
+            FilterType bestType = FilterType::None;
+            double bestBits = 0.0;
+            for (uint8_t t = 0; t < kFilterTypeCount; ++t) {
+                const auto type = static_cast<FilterType>(t);
+                size_t used = 0;
+                for (size_t y = y0; y < y1; y += sampleStep) {
+                    const uint8_t* cur = src + y * srcStride;
+                    const uint8_t* prev = y > 0 ? cur - srcStride : zeroRow.data();
+                    filterRow(type, cur + x0, prev + x0, width, bpp, sample.data() + used);
+                    used += width;
+                }
+                const double bits = entropyBits(sample.data(), used, cLog2c);
+                if (t == 0 || bits < bestBits) {
+                    bestBits = bits;
+                    bestType = type;
+                }
+            }
+            map[ty * tilesX + tx] = static_cast<uint8_t>(bestType);
+
+            for (size_t y = y0; y < y1; ++y) {
+                const uint8_t* cur = src + y * srcStride;
+                const uint8_t* prev = y > 0 ? cur - srcStride : zeroRow.data();
+                filterRow(bestType, cur + x0, prev + x0, width, bpp, dst + y * rowBytes + x0);
+            }
+        }
+    }
+}
+
+bool unfilterTiles(const uint8_t* map, const uint8_t* src, size_t rows, size_t rowBytes, size_t bpp,
+                   size_t tileBytes, size_t tileRows, uint8_t* dst, size_t dstStride) {
+    const size_t tilesX = (rowBytes + tileBytes - 1) / tileBytes;
+    for (size_t i = 0; i < tileCount(rows, rowBytes, tileBytes, tileRows); ++i) {
+        if (map[i] >= kFilterTypeCount) return false;
+    }
+
+    // 按行顺序解码，保证 Up/Average/Paeth 引用的上一行已经还原
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* tileTypes = map + (y / tileRows) * tilesX;
+        const uint8_t* in = src + y * rowBytes;
+        uint8_t* out = dst + y * dstStride;
+        const uint8_t* prev = y > 0 ? out - dstStride : zeroRow.data();
+        for (size_t tx = 0; tx < tilesX; ++tx) {
+            const size_t x0 = tx * tileBytes;
+            const size_t width = x0 + tileBytes < rowBytes ? tileBytes : rowBytes - x0;
+            unfilterRow(static_cast<FilterType>(tileTypes[tx]), in + x0, prev + x0, width, bpp, out + x0);
+        }
+    }
+    return true;
+}
+
+bool unfilterRows(const uint8_t* src, size_t rows, size_t rowBytes, size_t bpp,
+                  uint8_t* dst, size_t dstStride) {
+    const std::vector<uint8_t> zeroRow(rowBytes, 0);
+
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* in = src + y * (rowBytes + 1);
+        if (in[0] >= kFilterTypeCount) return false;
+
+        uint8_t* out = dst + y * dstStride;
+        const uint8_t* prev = y > 0 ? out - dstStride : zeroRow.data();
+        unfilterRow(static_cast<FilterType>(in[0]), in + 1, prev, rowBytes, bpp, out);
+    }
+    return true;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,41 @@
+#ifndef PIXELFILTER_H
+#define PIXELFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // PNG 风格的行预测滤波类型
+    enum class FilterType : uint8_t { None = 0, Sub, Up, Average, Paeth };
+    constexpr uint8_t kFilterTypeCount = 5;
+
+    // 单行滤波/反滤波，prev 为上一行（首行传全 0 行），bpp 为同一通道相邻样本的字节间距
+    void filterRow(FilterType type, const uint8_t* cur, const uint8_t* prev,
+                   size_t rowBytes, size_t bpp, uint8_t* out);
+    void unfilterRow(FilterType type, const uint8_t* in, const uint8_t* prev,
+                     size_t rowBytes, size_t bpp, uint8_t* out);
+
+    // 滤波结果的代价估计（按有符号字节的绝对值求和）
+    uint64_t filterCost(const uint8_t* data, size_t size);
+
+    // 逐行选择代价最小的滤波器，dst 每行以 1 字节滤波类型开头，大小为 rows * (rowBytes + 1)
+    void filterRows(const uint8_t* src, size_t srcStride, size_t rows, size_t rowBytes, size_t bpp,
+                    uint8_t* dst);
+    bool unfilterRows(const uint8_t* src, size_t rows, size_t rowBytes, size_t bpp,
+                      uint8_t* dst, size_t dstStride);
+
+    // 分块自适应滤波：每块（tileBytes 字节 x tileRows 行）按抽样行的熵估计选择滤波器，
+    // 选择结果写入 map（行优先，每块 1 字节）；dst 为不带类型字节的 rows * rowBytes 滤波结果。
+    // 块内每行按独立行段处理，块左边界不引用相邻块的像素
+    size_t tileCount(size_t rows, size_t rowBytes, size_t tileBytes, size_t tileRows);
+    void filterTiles(const uint8_t* src, size_t srcStride, size_t rows, size_t rowBytes, size_t bpp,
+                     size_t tileBytes, size_t tileRows, uint8_t* map, uint8_t* dst);
+    bool unfilterTiles(const uint8_t* map, const uint8_t* src, size_t rows, size_t rowBytes, size_t bpp,
+                       size_t tileBytes, size_t tileRows, uint8_t* dst, size_t dstStride);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELFILTER_H
@@ -0,0 +1,211 @@
+#include "pixelPalette.h"
+#include <cstring>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr size_t kPaletteHeaderSize = 2;
+// 哈希表槽数为最大颜色数的 4 倍，负载不超过 25%
+constexpr size_t kHashBits = 10;
+constexpr size_t kHashSlots = size_t(1) << kHashBits;
+
+template <size_t Bpp>
+inline uint32_t loadColor(const uint8_t* p) {
+    uint32_t color = 0;
+    std::memcpy(&color, p, Bpp);
+    return color;
+}
+
+inline size_t hashColor(uint32_t color) {
+    return (color * 2654435761u) >> (32 - kHashBits);
+}
+
+// 开放寻址的颜色计数器：slots 存放 调色板下标 + 1，0 表示空槽
+class ColorTable {
+public:
+    ColorTable() { std::memset(m_slots, 0, sizeof(m_slots)); }
+
+    // 返回颜色的调色板下标，新颜色追加到末尾；颜色数超限时返回 -1
+    int indexOf(uint32_t color) {
+        size_t slot = hashColor(color);
+        while (m_slots[slot] != 0) {
+            const int index = m_slots[slot] - 1;
+            if (m_colors[index] == color) return index;
+            slot = (slot + 1) & (kHashSlots - 1);
+        }
+        if (m_count == kMaxPaletteColors) return -1;
+        m_colors[m_count] = color;
+        m_slots[slot] = static_cast<uint16_t>(++m_count);
+        return static_cast<int>(m_count - 1);
+    }
+
+    size_t count() const { return m_count; }
+    uint32_t color(size_t index) const { return m_colors[index]; }
+
+private:
+    uint16_t m_slots[kHashSlots];
+    uint32_t m_colors[kMaxPaletteColors] = {};
+    size_t m_count = 0;
+};
+
+// 逐像素映射到 8 位索引；相邻像素同色时跳过哈希查找（截图、UI 中很常见）
+template <size_t Bpp>
+bool mapColors(const uint8_t* src, size_t srcStride, size_t width, size_t rows,
+               ColorTable& table, uint8_t* indices) {
+    uint32_t lastColor = loadColor<Bpp>(src);
+    int lastIndex = table.indexOf(lastColor);
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* row = src + y * srcStride;
+        uint8_t* out = indices + y * width;
+        for (size_t x = 0; x < width; ++x) {
+            const uint32_t color = loadColor<Bpp>(row + x * Bpp);
+            if (color != lastColor) {
+                lastIndex = table.indexOf(color);
+                if (lastIndex < 0) return false;
+                lastColor = color;
+            }
+            out[x] = static_cast<uint8_t>(lastIndex);
+        }
+    }
+    return true;
+}
+
+// 索引按位宽打包/解包，高位在前；Bits 为编译期常量以避免逐像素的除法
+template <size_t Bits>
+void packIndices(const uint8_t* indices, size_t width, uint8_t* out) {
+    constexpr size_t kPerByte = 8 / Bits;
+    size_t x = 0;
+    for (; x + kPerByte <= width; x += kPerByte) {
+        uint8_t byte = 0;
+        for (size_t k = 0; k < kPerByte; ++k) byte = static_cast<uint8_t>((byte << Bits) | indices[x + k]);
+        *out++ = byte;
+    }
+    if (x < width) {
+        uint8_t byte = 0;
+        for (size_t k = 0; k < kPerByte; ++k) {
+            byte = static_cast<uint8_t>((byte << Bits) | (x + k < width ? indices[x + k] : 0));
+        }
+        *out = byte;
+    }
+}
+
+template <size_t Bits>
+void unpackIndices(const uint8_t* in, size_t width, uint8_t* indices) {
+    constexpr size_t kPerByte = 8 / Bits;
+    constexpr uint8_t kMask = static_cast<uint8_t>((1u << Bits) - 1);
+    size_t x = 0;
+    for (; x + kPerByte <= width; x += kPerByte) {
+        const uint8_t byte = *in++;
+        for (size_t k = 0; k < kPerByte; ++k) {
+            indices[x + k] = static_cast<uint8_t>((byte >> (8 - Bits * (k + 1))) & kMask);
+        }
+    }
+    for (size_t k = 0; x < width; ++x, ++k) {
+        indices[x] = static_cast<uint8_t>((*in >> (8 - Bits * (k + 1))) & kMask);
+    }
+}
+
+template <size_t Bpp>
+void expandRow(const uint8_t* indices, size_t width, const uint8_t* palette, uint8_t* out) {
+    for (size_t x = 0; x < width; ++x) {
+        std::memcpy(out + x * Bpp, palette + indices[x] * Bpp, Bpp);
+    }
+}
+
+void expandRow(const uint8_t* indices, size_t width, const uint8_t* palette, size_t bpp, uint8_t* out) {
+    switch (bpp) {
+        case 1: expandRow<1>(indices, width, palette, out); break;
+        case 2: expandRow<2>(indices, width, palette, out); break;
+        case 3: expandRow<3>(indices, width, palette, out); break;
+        default: expandRow<4>(indices, width, palette, out); break;
+    }
+}
+
+} // namespace
+
+size_t paletteIndexBits(size_t colors) {
+    if (colors <= 2) return 1;
+    if (colors <= 4) return 2;
+    if (colors <= 16) return 4;
+    return 8;
+}
+
+bool encodePalette(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+                   std::vector<uint8_t>& out) {
+    if (bpp == 0 || bpp > 4 || width == 0 || rows == 0) return false;
+
+    ColorTable table;
+    std::vector<uint8_t> indices(width * rows);
+    bool mapped = false;
+    switch (bpp) {
+        case 1: mapped = mapColors<1>(src, srcStride, width, rows, table, indices.data()); break;
+        case 2: mapped = mapColors<2>(src, srcStride, width, rows, table, indices.data()); break;
+        case 3: mapped = mapColors<3>(src, srcStride, width, rows, table, indices.data()); break;
+        default: mapped = mapColors<4>(src, srcStride, width, rows, table, indices.data()); break;
+    }
+    if (!mapped) return false;
+
+    const size_t colors = table.count();
+    const size_t bits = paletteIndexBits(colors);
+    const size_t rowBytes = (width * bits + 7) / 8;
+    out.resize(kPaletteHeaderSize + colors * bpp + rowBytes * rows);
+    out[0] = static_cast<uint8_t>(colors);
+    out[1] = static_cast<uint8_t>(colors >> 8);
+    for (size_t i = 0; i < colors; ++i) {
+        const uint32_t color = table.color(i);
+        std::memcpy(out.data() + kPaletteHeaderSize + i * bpp, &color, bpp);
+    }
+
+    uint8_t* packed = out.data() + kPaletteHeaderSize + colors * bpp;
+    if (bits == 8) {
+        std::memcpy(packed, indices.data(), indices.size());
+        return true;
+    }
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* in = indices.data() + y * width;
+        uint8_t* row = packed + y * rowBytes;
+        switch (bits) {
+            case 1: packIndices<1>(in, width, row); break;
+            case 2: packIndices<2>(in, width, row); break;
+            default: packIndices<4>(in, width, row); break;
+        }
+    }
+    return true;
+}
+
+bool decodePalette(const uint8_t* src, size_t size, size_t width, size_t rows, size_t bpp,
+                   uint8_t* dst, size_t dstStride) {
+    if (bpp == 0 || bpp > 4 || size < kPaletteHeaderSize) return false;
+
+    const size_t colors = static_cast<size_t>(src[0]) | (static_cast<size_t>(src[1]) << 8);
+    if (colors == 0 || colors > kMaxPaletteColors) return false;
+    const size_t bits = paletteIndexBits(colors);
+    const size_t rowBytes = (width * bits + 7) / 8;
+    if (size != kPaletteHeaderSize + colors * bpp + rowBytes * rows) return false;
+
+    // 颜色表补齐到 256 项，越界索引解出 0 而不会读出界
+    uint8_t palette[kMaxPaletteColors * 4] = {};
+    std::memcpy(palette, src + kPaletteHeaderSize, colors * bpp);
+    const uint8_t* packed = src + kPaletteHeaderSize + colors * bpp;
+
+    std::vector<uint8_t> indices(width);
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* row = packed + y * rowBytes;
+        const uint8_t* rowIndices = row;
+        if (bits != 8) {
+            switch (bits) {
+                case 1: unpackIndices<1>(row, width, indices.data()); break;
+                case 2: unpackIndices<2>(row, width, indices.data()); break;
+                default: unpackIndices<4>(row, width, indices.data()); break;
+            }
+            rowIndices = indices.data();
+        }
+        expandRow(rowIndices, width, palette, bpp, dst + y * dstStride);
+    }
+    return true;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
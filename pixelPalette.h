@@ -0,0 +1,28 @@
+#ifndef PIXELPALETTE_H
+#define PIXELPALETTE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 调色板可容纳的最大颜色数
+    constexpr size_t kMaxPaletteColors = 256;
+
+    // 索引位宽：2/4/16/256 色分别使用 1/2/4/8 位
+    size_t paletteIndexBits(size_t colors);
+
+    // 单遍哈希统计颜色并生成调色板编码，颜色数超过 kMaxPaletteColors 时立即返回 false。
+    // 输出布局：LE16 颜色数 | 颜色表（每色 bpp 字节）| 索引行（每行按位宽紧凑打包、高位在前、按字节对齐）
+    bool encodePalette(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+                       std::vector<uint8_t>& out);
+    // encodePalette 的逆过程，数据大小与图像尺寸不符时返回 false
+    bool decodePalette(const uint8_t* src, size_t size, size_t width, size_t rows, size_t bpp,
+                       uint8_t* dst, size_t dstStride);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELPALETTE_H
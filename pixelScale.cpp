@@ -0,0 +1,145 @@
+#include "pixelScale.h"
+#include "pixelSimd.h"
+#include <algorithm>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+#if BMP_HAVE_SSE2
+inline __m128i loadu(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void storeu(uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+// 单通道：偶数 / 奇数字节分别扩展成 16 位后四项相加，一次输出 16 个像素
+size_t downsampleRow1Sse2(const uint8_t* r0, const uint8_t* r1, size_t pairs, uint8_t* dst) {
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    const __m128i round = _mm_set1_epi16(2);
+    size_t x = 0;
+    for (; x + 16 <= pairs; x += 16) {
+        __m128i sums[2];
+        for (int half = 0; half < 2; ++half) {
+            const __m128i a = loadu(r0 + x * 2 + half * 16);
+            const __m128i b = loadu(r1 + x * 2 + half * 16);
+            const __m128i even = _mm_add_epi16(_mm_and_si128(a, lowMask), _mm_and_si128(b, lowMask));
+            const __m128i odd = _mm_add_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+            sums[half] = _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(even, odd), round), 2);
+        }
+        storeu(dst + x, _mm_packus_epi16(sums[0], sums[1]));
+    }
+    return x;
+}
+
+// 4 通道：扩展后每个寄存器正好是相邻两个像素，高低 64 位相加即完成水平方向，一次输出 4 个像素
+size_t downsampleRow4Sse2(const uint8_t* r0, const uint8_t* r1, size_t pairs, uint8_t* dst) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+    size_t x = 0;
+    for (; x + 4 <= pairs; x += 4) {
+        __m128i sums[4];
+        for (int i = 0; i < 2; ++i) {
+            const __m128i a = loadu(r0 + x * 8 + i * 16);
+            const __m128i b = loadu(r1 + x * 8 + i * 16);
+            sums[i * 2] = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+            sums[i * 2 + 1] = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+        }
+        const __m128i p01 = _mm_add_epi16(_mm_unpacklo_epi64(sums[0], sums[1]), _mm_unpackhi_epi64(sums[0], sums[1]));
+        const __m128i p23 = _mm_add_epi16(_mm_unpacklo_epi64(sums[2], sums[3]), _mm_unpackhi_epi64(sums[2], sums[3]));
+        storeu(dst + x * 4, _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(p01, round), 2),
+                                             _mm_srli_epi16(_mm_add_epi16(p23, round), 2)));
+    }
+    return x;
+}
+
+// 其它通道数：先用 SIMD 做垂直方向求和，水平方向再逐样本合并
+void verticalSumSse2(const uint8_t* r0, const uint8_t* r1, size_t count, uint16_t* sums) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a = loadu(r0 + i);
+        const __m128i b = loadu(r1 + i);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i),
+                         _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(sums + i + 8),
+                         _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)));
+    }
+    for (; i < count; ++i) sums[i] = static_cast<uint16_t>(r0[i] + r1[i]);
+}
+#endif
+
+void downsampleRow8(const uint8_t* r0, const uint8_t* r1, size_t width, size_t channels,
+                    std::vector<uint16_t>& sums, uint8_t* dst) {
+    const size_t pairs = width / 2;
+    size_t x = 0;
+#if BMP_HAVE_SSE2
+    if (channels == 1) {
+        x = downsampleRow1Sse2(r0, r1, pairs, dst);
+    } else if (channels == 4) {
+        x = downsampleRow4Sse2(r0, r1, pairs, dst);
+    } else {
+        verticalSumSse2(r0, r1, pairs * 2 * channels, sums.data());
+        for (size_t i = 0; i < pairs * channels; ++i) {
+            const size_t p = i / channels;
+            const size_t c = i - p * channels;
+            dst[i] = static_cast<uint8_t>((sums[p * 2 * channels + c] + sums[(p * 2 + 1) * channels + c] + 2) >> 2);
+        }
+        x = pairs;
+    }
+#else
+    (void)sums;
+#endif
+    for (; x < pairs; ++x) {
+        const uint8_t* a = r0 + x * 2 * channels;
+        const uint8_t* b = r1 + x * 2 * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            dst[x * channels + c] = static_cast<uint8_t>((a[c] + a[c + channels] + b[c] + b[c + channels] + 2) >> 2);
+        }
+    }
+    if (width & 1) {
+        const uint8_t* a = r0 + (width - 1) * channels;
+        const uint8_t* b = r1 + (width - 1) * channels;
+        for (size_t c = 0; c < channels; ++c) {
+            dst[pairs * channels + c] = static_cast<uint8_t>((a[c] + b[c] + 1) >> 1);
+        }
+    }
+}
+
+inline uint32_t sample16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+void downsampleRow16(const uint8_t* r0, const uint8_t* r1, size_t width, size_t channels, uint8_t* dst) {
+    const size_t pixelBytes = channels * 2;
+    for (size_t x = 0; x < halfSize(width); ++x) {
+        // 奇数宽的最后一列与自身平均
+        const size_t x1 = std::min(x * 2 + 1, width - 1);
+        for (size_t c = 0; c < channels; ++c) {
+            const size_t o0 = x * 2 * pixelBytes + c * 2;
+            const size_t o1 = x1 * pixelBytes + c * 2;
+            const uint32_t value = (sample16(r0 + o0) + sample16(r0 + o1) + sample16(r1 + o0) + sample16(r1 + o1) + 2) >> 2;
+            dst[x * pixelBytes + c * 2] = static_cast<uint8_t>(value);
+            dst[x * pixelBytes + c * 2 + 1] = static_cast<uint8_t>(value >> 8);
+        }
+    }
+}
+
+} // namespace
+
+void downsampleHalf(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t channels,
+                    size_t sampleBytes, uint8_t* dst, size_t dstStride) {
+    std::vector<uint16_t> sums(sampleBytes == 1 ? width * channels : 0);
+    for (size_t y = 0; y < halfSize(rows); ++y) {
+        const uint8_t* r0 = src + y * 2 * srcStride;
+        const uint8_t* r1 = (y * 2 + 1 < rows) ? r0 + srcStride : r0;
+        uint8_t* out = dst + y * dstStride;
+        if (sampleBytes == 1) {
+            downsampleRow8(r0, r1, width, channels, sums, out);
+        } else {
+            downsampleRow16(r0, r1, width, channels, out);
+        }
+    }
+}
+
+} // namespace detail
+} // namespace zstd_compressor
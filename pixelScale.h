@@ -0,0 +1,21 @@
+#ifndef PIXELSCALE_H
+#define PIXELSCALE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 缩小后的尺寸：奇数边向上取整
+    inline size_t halfSize(size_t size) { return (size + 1) / 2; }
+
+    // 2x2 盒式滤波缩小一半（四舍五入取平均），输出 halfSize(width) x halfSize(rows)；
+    // 奇数宽 / 高的最后一列 / 行与自身平均。sampleBytes 为 1（8 位）或 2（16 位小端样本）
+    void downsampleHalf(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t channels,
+                        size_t sampleBytes, uint8_t* dst, size_t dstStride);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELSCALE_H
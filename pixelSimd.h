@@ -0,0 +1,49 @@
+#ifndef PIXELSIMD_H
+#define PIXELSIMD_H
+
+// 像素预处理内核使用的 SIMD 检测；不支持时退回标量实现
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define BMP_HAVE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define BMP_HAVE_SSE2 0
+#endif
+
+// SSSE3 不在 x86-64 基线中：内核单独按目标编译，运行时检测 CPU 后再调用
+#if BMP_HAVE_SSE2 && (defined(__GNUC__) || defined(_MSC_VER))
+    #define BMP_HAVE_SSSE3 1
+    #include <tmmintrin.h>
+    #if defined(__GNUC__)
+        #define BMP_TARGET_SSSE3 __attribute__((target("ssse3")))
+    #else
+        #define BMP_TARGET_SSSE3
+        #include <intrin.h>
+    #endif
+#else
+    #define BMP_HAVE_SSSE3 0
+#endif
+
+namespace zstd_compressor {
+namespace detail {
+
+#if BMP_HAVE_SSSE3
+    inline bool cpuHasSsse3() {
+    #if defined(__GNUC__)
+        static const bool supported = __builtin_cpu_supports("ssse3");
+    #else
+        static const bool supported = [] {
+            int info[4] = {};
+            __cpuid(info, 1);
+            return (info[2] & (1 << 9)) != 0;
+        }();
+    #endif
+        return supported;
+    }
+#else
+    inline bool cpuHasSsse3() { return false; }
+#endif
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELSIMD_H
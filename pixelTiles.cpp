@@ -0,0 +1,128 @@
+#include "pixelTiles.h"
+#include <algorithm>
+#include <cstring>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+// 把一个像素展开成 count 个像素的行模板：单字节直接 memset，否则按倍增拷贝
+void expandPixel(const uint8_t* pixel, size_t bpp, size_t count, uint8_t* pattern) {
+    if (bpp == 1) {
+        std::memset(pattern, pixel[0], count);
+        return;
+    }
+    const size_t total = count * bpp;
+    std::memcpy(pattern, pixel, bpp);
+    size_t filled = bpp;
+    while (filled < total) {
+        const size_t chunk = std::min(filled, total - filled);
+        std::memcpy(pattern + filled, pattern, chunk);
+        filled += chunk;
+    }
+}
+
+inline bool tileIsConstant(const uint8_t* bitmap, size_t tile) {
+    return (bitmap[tile >> 3] >> (tile & 7)) & 1;
+}
+
+} // namespace
+
+size_t constantTileCount(size_t width, size_t rows, size_t tileWidth, size_t tileRows) {
+    return ((width + tileWidth - 1) / tileWidth) * ((rows + tileRows - 1) / tileRows);
+}
+
+size_t scanConstantTiles(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+                         size_t tileWidth, size_t tileRows, uint8_t* bitmap, std::vector<uint8_t>& fills) {
+    const size_t tiles = constantTileCount(width, rows, tileWidth, tileRows);
+    std::memset(bitmap, 0, (tiles + 7) / 8);
+    fills.clear();
+
+    // 模板只在块首像素变化时重建，大片同色背景只展开一次
+    std::vector<uint8_t> pattern(tileWidth * bpp);
+    bool patternValid = false;
+    size_t constant = 0;
+    size_t tile = 0;
+    for (size_t y0 = 0; y0 < rows; y0 += tileRows) {
+        const size_t y1 = std::min(rows, y0 + tileRows);
+        for (size_t x0 = 0; x0 < width; x0 += tileWidth, ++tile) {
+            const size_t bytes = (std::min(width, x0 + tileWidth) - x0) * bpp;
+            const uint8_t* first = src + y0 * srcStride + x0 * bpp;
+            if (!patternValid || std::memcmp(pattern.data(), first, bpp) != 0) {
+                expandPixel(first, bpp, tileWidth, pattern.data());
+                patternValid = true;
+            }
+
+            bool uniform = true;
+            for (size_t y = y0; y < y1 && uniform; ++y) {
+                uniform = std::memcmp(src + y * srcStride + x0 * bpp, pattern.data(), bytes) == 0;
+            }
+            if (!uniform) continue;
+
+            bitmap[tile >> 3] |= static_cast<uint8_t>(1u << (tile & 7));
+            fills.insert(fills.end(), first, first + bpp);
+            ++constant;
+        }
+    }
+    return constant;
+}
+
+void packTiles(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+               size_t tileWidth, size_t tileRows, const uint8_t* bitmap, uint8_t* dst, size_t dstStride) {
+    const size_t tileBytes = tileWidth * bpp;
+    size_t tile = 0;
+    for (size_t y0 = 0; y0 < rows; y0 += tileRows) {
+        for (size_t x0 = 0; x0 < width; x0 += tileWidth, ++tile) {
+            if (tileIsConstant(bitmap, tile)) continue;
+
+            const size_t pixels = std::min(width, x0 + tileWidth) - x0;
+            for (size_t r = 0; r < tileRows; ++r) {
+                // 底部不足的块重复最后一行，右侧不足的块重复最后一个像素
+                const uint8_t* row = src + std::min(y0 + r, rows - 1) * srcStride + x0 * bpp;
+                uint8_t* out = dst + r * dstStride;
+                std::memcpy(out, row, pixels * bpp);
+                if (pixels < tileWidth) {
+                    expandPixel(row + (pixels - 1) * bpp, bpp, tileWidth - pixels, out + pixels * bpp);
+                }
+            }
+            dst += tileBytes;
+        }
+    }
+}
+
+void unpackTiles(const uint8_t* src, size_t srcStride, const uint8_t* fills, size_t width, size_t rows,
+                 size_t bpp, size_t tileWidth, size_t tileRows, const uint8_t* bitmap,
+                 uint8_t* dst, size_t dstStride) {
+    const size_t tileBytes = tileWidth * bpp;
+    std::vector<uint8_t> pattern(tileBytes);
+    const uint8_t* patternPixel = nullptr;
+    size_t tile = 0;
+    for (size_t y0 = 0; y0 < rows; y0 += tileRows) {
+        const size_t y1 = std::min(rows, y0 + tileRows);
+        for (size_t x0 = 0; x0 < width; x0 += tileWidth, ++tile) {
+            const size_t bytes = (std::min(width, x0 + tileWidth) - x0) * bpp;
+            uint8_t* out = dst + y0 * dstStride + x0 * bpp;
+            if (tileIsConstant(bitmap, tile)) {
+                if (!patternPixel || std::memcmp(patternPixel, fills, bpp) != 0) {
+                    expandPixel(fills, bpp, tileWidth, pattern.data());
+                }
+                patternPixel = fills;
+                fills += bpp;
+                for (size_t y = y0; y < y1; ++y, out += dstStride) {
+                    std::memcpy(out, pattern.data(), bytes);
+                }
+                continue;
+            }
+
+            const uint8_t* in = src;
+            for (size_t y = y0; y < y1; ++y, out += dstStride, in += srcStride) {
+                std::memcpy(out, in, bytes);
+            }
+            src += tileBytes;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace zstd_compressor
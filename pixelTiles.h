@@ -0,0 +1,31 @@
+#ifndef PIXELTILES_H
+#define PIXELTILES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 按 tileWidth 像素 x tileRows 行分块后的块数（右侧、底部不足的部分也算一块）
+    size_t constantTileCount(size_t width, size_t rows, size_t tileWidth, size_t tileRows);
+
+    // 找出所有像素相同的块：bitmap 按块顺序（逐行、低位在前）置位，fills 依次追加每个常量块的像素值，
+    // 返回常量块数。每块先取首像素展开成一行模板，再逐行与模板比较，出现不同立即跳到下一块
+    size_t scanConstantTiles(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+                             size_t tileWidth, size_t tileRows, uint8_t* bitmap, std::vector<uint8_t>& fills);
+
+    // 非常量块按顺序横向拼接成 tileRows 行的紧凑图像（每行 dstStride 字节），
+    // 同一块带内相邻的块保持相邻；边缘不足的块复制最后一列 / 一行补齐
+    void packTiles(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t bpp,
+                   size_t tileWidth, size_t tileRows, const uint8_t* bitmap, uint8_t* dst, size_t dstStride);
+    // packTiles 的逆过程，同时用 fills 填充常量块
+    void unpackTiles(const uint8_t* src, size_t srcStride, const uint8_t* fills, size_t width, size_t rows,
+                     size_t bpp, size_t tileWidth, size_t tileRows, const uint8_t* bitmap,
+                     uint8_t* dst, size_t dstStride);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELTILES_H
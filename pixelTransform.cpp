@@ -0,0 +1,491 @@
+#include "pixelTransform.h"
+#include "pixelSimd.h"
+#include <cstring>
+#include <vector>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+#if BMP_HAVE_SSE2
+inline __m128i loadu(const uint8_t* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline void storeu(uint8_t* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+// 2 通道（16 位样本的低/高字节）：掩码取低字节、移位取高字节后饱和打包
+size_t split2Sse2(const uint8_t* src, size_t pixels, uint8_t* const* planes) {
+    const __m128i lowMask = _mm_set1_epi16(0x00FF);
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i v0 = loadu(src + p * 2);
+        const __m128i v1 = loadu(src + p * 2 + 16);
+        storeu(planes[0] + p, _mm_packus_epi16(_mm_and_si128(v0, lowMask), _mm_and_si128(v1, lowMask)));
+        storeu(planes[1] + p, _mm_packus_epi16(_mm_srli_epi16(v0, 8), _mm_srli_epi16(v1, 8)));
+    }
+    return p;
+}
+
+size_t merge2Sse2(const uint8_t* const* planes, size_t pixels, uint8_t* dst) {
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i c0 = loadu(planes[0] + p);
+        const __m128i c1 = loadu(planes[1] + p);
+        storeu(dst + p * 2, _mm_unpacklo_epi8(c0, c1));
+        storeu(dst + p * 2 + 16, _mm_unpackhi_epi8(c0, c1));
+    }
+    return p;
+}
+
+// 4 通道：四轮 (0,2)/(1,3) 配对的 unpack 即可完成 16 像素的转置
+size_t split4Sse2(const uint8_t* src, size_t pixels, uint8_t* const* planes) {
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        __m128i v0 = loadu(src + p * 4);
+        __m128i v1 = loadu(src + p * 4 + 16);
+        __m128i v2 = loadu(src + p * 4 + 32);
+        __m128i v3 = loadu(src + p * 4 + 48);
+        for (int round = 0; round < 4; ++round) {
+            const __m128i t0 = _mm_unpacklo_epi8(v0, v2);
+            const __m128i t1 = _mm_unpackhi_epi8(v0, v2);
+            const __m128i t2 = _mm_unpacklo_epi8(v1, v3);
+            const __m128i t3 = _mm_unpackhi_epi8(v1, v3);
+            v0 = t0; v1 = t1; v2 = t2; v3 = t3;
+        }
+        storeu(planes[0] + p, v0);
+        storeu(planes[1] + p, v1);
+        storeu(planes[2] + p, v2);
+        storeu(planes[3] + p, v3);
+    }
+    return p;
+}
+
+size_t merge4Sse2(const uint8_t* const* planes, size_t pixels, uint8_t* dst) {
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i c0 = loadu(planes[0] + p);
+        const __m128i c1 = loadu(planes[1] + p);
+        const __m128i c2 = loadu(planes[2] + p);
+        const __m128i c3 = loadu(planes[3] + p);
+        const __m128i lo01 = _mm_unpacklo_epi8(c0, c1);
+        const __m128i hi01 = _mm_unpackhi_epi8(c0, c1);
+        const __m128i lo23 = _mm_unpacklo_epi8(c2, c3);
+        const __m128i hi23 = _mm_unpackhi_epi8(c2, c3);
+        storeu(dst + p * 4, _mm_unpacklo_epi16(lo01, lo23));
+        storeu(dst + p * 4 + 16, _mm_unpackhi_epi16(lo01, lo23));
+        storeu(dst + p * 4 + 32, _mm_unpacklo_epi16(hi01, hi23));
+        storeu(dst + p * 4 + 48, _mm_unpackhi_epi16(hi01, hi23));
+    }
+    return p;
+}
+
+// 冗余通道扫描：cmpeq(v, v >> 1 字节) 的第 j 位表示 byte[j] == byte[j + 1]，
+// 灰度要求每个像素的 (0,1)、(1,2) 两对相等；返回已处理的像素数
+size_t scan4Sse2(const uint8_t* src, size_t pixels, uint8_t alpha, bool& gray, bool& constant) {
+    const __m128i alphaVec = _mm_set1_epi8(static_cast<char>(alpha));
+    size_t p = 0;
+    // 读 p * 4 + 1 开始的 16 字节，最后一组需要多 1 字节
+    for (; p + 5 <= pixels && (gray || constant); p += 4) {
+        const __m128i v = loadu(src + p * 4);
+        if (gray) gray = (_mm_movemask_epi8(_mm_cmpeq_epi8(v, loadu(src + p * 4 + 1))) & 0x3333) == 0x3333;
+        if (constant) constant = (_mm_movemask_epi8(_mm_cmpeq_epi8(v, alphaVec)) & 0x8888) == 0x8888;
+    }
+    return p;
+}
+
+size_t scan3Sse2(const uint8_t* src, size_t pixels, bool& gray) {
+    // 16 像素 = 48 字节，三个向量中像素起始位置的相位各不相同
+    size_t p = 0;
+    for (; p + 17 <= pixels && gray; p += 16) {
+        const uint8_t* base = src + p * 3;
+        const int m0 = _mm_movemask_epi8(_mm_cmpeq_epi8(loadu(base), loadu(base + 1)));
+        const int m1 = _mm_movemask_epi8(_mm_cmpeq_epi8(loadu(base + 16), loadu(base + 17)));
+        const int m2 = _mm_movemask_epi8(_mm_cmpeq_epi8(loadu(base + 32), loadu(base + 33)));
+        gray = (m0 & 0xB6DB) == 0xB6DB && (m1 & 0xDB6D) == 0xDB6D && (m2 & 0x6DB6) == 0x6DB6;
+    }
+    return p;
+}
+
+// 有符号字节算术右移 1 位：逻辑右移后把第 6 位符号扩展
+inline __m128i srai1Epi8(__m128i x) {
+    const __m128i shifted = _mm_and_si128(_mm_srli_epi16(x, 1), _mm_set1_epi8(0x7F));
+    const __m128i sign = _mm_set1_epi8(0x40);
+    return _mm_sub_epi8(_mm_xor_si128(shifted, sign), sign);
+}
+#endif
+
+inline uint8_t srai1(uint8_t x) {
+    return static_cast<uint8_t>(static_cast<int8_t>(x) >> 1);
+}
+
+// 8x8 位矩阵转置：第 r 字节的第 c 位与第 c 字节的第 r 位互换
+inline uint64_t transpose8x8(uint64_t x) {
+    uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull;
+    x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull;
+    x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull;
+    x ^= t ^ (t << 28);
+    return x;
+}
+
+inline uint64_t loadLE64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; --i) v = (v << 8) | p[i];
+    return v;
+}
+
+inline void storeLE64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; ++i) p[i] = static_cast<uint8_t>(v >> (i * 8));
+}
+
+#if BMP_HAVE_SSSE3
+// 3 通道：每个平面由三个输入向量各自 pshufb 后合并
+BMP_TARGET_SSSE3
+size_t split3Ssse3(const uint8_t* src, size_t pixels, uint8_t* const* planes) {
+    const __m128i m00 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i m01 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i m02 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i m10 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i m11 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i m12 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i m20 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i m21 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i m22 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i v0 = loadu(src + p * 3);
+        const __m128i v1 = loadu(src + p * 3 + 16);
+        const __m128i v2 = loadu(src + p * 3 + 32);
+        storeu(planes[0] + p, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, m00), _mm_shuffle_epi8(v1, m01)),
+                                           _mm_shuffle_epi8(v2, m02)));
+        storeu(planes[1] + p, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, m10), _mm_shuffle_epi8(v1, m11)),
+                                           _mm_shuffle_epi8(v2, m12)));
+        storeu(planes[2] + p, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, m20), _mm_shuffle_epi8(v1, m21)),
+                                           _mm_shuffle_epi8(v2, m22)));
+    }
+    return p;
+}
+
+BMP_TARGET_SSSE3
+size_t merge3Ssse3(const uint8_t* const* planes, size_t pixels, uint8_t* dst) {
+    const __m128i m00 = _mm_setr_epi8(0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1, 5);
+    const __m128i m01 = _mm_setr_epi8(-1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1, -1);
+    const __m128i m02 = _mm_setr_epi8(-1, -1, 0, -1, -1, 1, -1, -1, 2, -1, -1, 3, -1, -1, 4, -1);
+    const __m128i m10 = _mm_setr_epi8(-1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10, -1);
+    const __m128i m11 = _mm_setr_epi8(5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1, 10);
+    const __m128i m12 = _mm_setr_epi8(-1, 5, -1, -1, 6, -1, -1, 7, -1, -1, 8, -1, -1, 9, -1, -1);
+    const __m128i m20 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+    const __m128i m21 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+    const __m128i m22 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+
+    size_t p = 0;
+    for (; p + 16 <= pixels; p += 16) {
+        const __m128i c0 = loadu(planes[0] + p);
+        const __m128i c1 = loadu(planes[1] + p);
+        const __m128i c2 = loadu(planes[2] + p);
+        storeu(dst + p * 3, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, m00), _mm_shuffle_epi8(c1, m01)),
+                                         _mm_shuffle_epi8(c2, m02)));
+        storeu(dst + p * 3 + 16, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, m10), _mm_shuffle_epi8(c1, m11)),
+                                              _mm_shuffle_epi8(c2, m12)));
+        storeu(dst + p * 3 + 32, _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(c0, m20), _mm_shuffle_epi8(c1, m21)),
+                                              _mm_shuffle_epi8(c2, m22)));
+    }
+    return p;
+}
+#endif
+
+} // namespace
+
+void splitChannels(const uint8_t* src, size_t pixels, size_t channels, uint8_t* const* planes) {
+    size_t p = 0;
+#if BMP_HAVE_SSE2
+    if (channels == 2) p = split2Sse2(src, pixels, planes);
+    if (channels == 4) p = split4Sse2(src, pixels, planes);
+#endif
+#if BMP_HAVE_SSSE3
+    if (channels == 3 && cpuHasSsse3()) p = split3Ssse3(src, pixels, planes);
+#endif
+    for (; p < pixels; ++p) {
+        for (size_t k = 0; k < channels; ++k) {
+            planes[k][p] = src[p * channels + k];
+        }
+    }
+}
+
+void mergeChannels(const uint8_t* const* planes, size_t pixels, size_t channels, uint8_t* dst) {
+    size_t p = 0;
+#if BMP_HAVE_SSE2
+    if (channels == 2) p = merge2Sse2(planes, pixels, dst);
+    if (channels == 4) p = merge4Sse2(planes, pixels, dst);
+#endif
+#if BMP_HAVE_SSSE3
+    if (channels == 3 && cpuHasSsse3()) p = merge3Ssse3(planes, pixels, dst);
+#endif
+    for (; p < pixels; ++p) {
+        for (size_t k = 0; k < channels; ++k) {
+            dst[p * channels + k] = planes[k][p];
+        }
+    }
+}
+
+void deinterleaveImage(const uint8_t* src, size_t srcStride, size_t width, size_t rows,
+                       size_t channels, uint8_t* dst) {
+    const size_t planeSize = width * rows;
+    std::vector<uint8_t*> planes(channels);
+    for (size_t y = 0; y < rows; ++y) {
+        for (size_t k = 0; k < channels; ++k) planes[k] = dst + k * planeSize + y * width;
+        splitChannels(src + y * srcStride, width, channels, planes.data());
+    }
+}
+
+void interleaveImage(const uint8_t* src, size_t width, size_t rows, size_t channels,
+                     uint8_t* dst, size_t dstStride) {
+    const size_t planeSize = width * rows;
+    std::vector<const uint8_t*> planes(channels);
+    for (size_t y = 0; y < rows; ++y) {
+        for (size_t k = 0; k < channels; ++k) planes[k] = src + k * planeSize + y * width;
+        mergeChannels(planes.data(), width, channels, dst + y * dstStride);
+    }
+}
+
+void forwardYCoCgR(uint8_t* r, uint8_t* g, uint8_t* b, size_t count) {
+    size_t i = 0;
+#if BMP_HAVE_SSE2
+    for (; i + 16 <= count; i += 16) {
+        const __m128i vr = loadu(r + i);
+        const __m128i vg = loadu(g + i);
+        const __m128i vb = loadu(b + i);
+        const __m128i co = _mm_sub_epi8(vr, vb);
+        const __m128i t = _mm_add_epi8(vb, srai1Epi8(co));
+        const __m128i cg = _mm_sub_epi8(vg, t);
+        storeu(r + i, co);
+        storeu(g + i, _mm_add_epi8(t, srai1Epi8(cg)));
+        storeu(b + i, cg);
+    }
+#endif
+    for (; i < count; ++i) {
+        const uint8_t co = static_cast<uint8_t>(r[i] - b[i]);
+        const uint8_t t = static_cast<uint8_t>(b[i] + srai1(co));
+        const uint8_t cg = static_cast<uint8_t>(g[i] - t);
+        r[i] = co;
+        g[i] = static_cast<uint8_t>(t + srai1(cg));
+        b[i] = cg;
+    }
+}
+
+void inverseYCoCgR(uint8_t* r, uint8_t* g, uint8_t* b, size_t count) {
+    size_t i = 0;
+#if BMP_HAVE_SSE2
+    for (; i + 16 <= count; i += 16) {
+        const __m128i co = loadu(r + i);
+        const __m128i y = loadu(g + i);
+        const __m128i cg = loadu(b + i);
+        const __m128i t = _mm_sub_epi8(y, srai1Epi8(cg));
+        const __m128i vb = _mm_sub_epi8(t, srai1Epi8(co));
+        storeu(g + i, _mm_add_epi8(cg, t));
+        storeu(b + i, vb);
+        storeu(r + i, _mm_add_epi8(vb, co));
+    }
+#endif
+    for (; i < count; ++i) {
+        const uint8_t co = r[i];
+        const uint8_t cg = b[i];
+        const uint8_t t = static_cast<uint8_t>(g[i] - srai1(cg));
+        const uint8_t vb = static_cast<uint8_t>(t - srai1(co));
+        g[i] = static_cast<uint8_t>(cg + t);
+        b[i] = vb;
+        r[i] = static_cast<uint8_t>(vb + co);
+    }
+}
+
+uint8_t scanRedundantChannels(const uint8_t* src, size_t srcStride, size_t width, size_t rows,
+                              size_t channels, uint8_t& alpha) {
+    if ((channels != 3 && channels != 4) || width == 0 || rows == 0) return REDUNDANT_NONE;
+
+    bool gray = true;
+    bool constant = channels == 4;
+    alpha = channels == 4 ? src[3] : 0;
+    for (size_t y = 0; y < rows && (gray || constant); ++y) {
+        const uint8_t* row = src + y * srcStride;
+        size_t p = 0;
+#if BMP_HAVE_SSE2
+        p = channels == 4 ? scan4Sse2(row, width, alpha, gray, constant) : scan3Sse2(row, width, gray);
+#endif
+        for (; p < width && (gray || constant); ++p) {
+            const uint8_t* px = row + p * channels;
+            if (gray) gray = px[0] == px[1] && px[1] == px[2];
+            if (constant) constant = px[3] == alpha;
+        }
+    }
+    return static_cast<uint8_t>((gray ? REDUNDANT_GRAY : 0) | (constant ? REDUNDANT_ALPHA : 0));
+}
+
+void dropChannels(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t channels,
+                  uint8_t redundant, uint8_t* dst) {
+    const bool gray = (redundant & REDUNDANT_GRAY) != 0;
+    const bool dropAlpha = channels == 4 && (redundant & REDUNDANT_ALPHA) != 0;
+    const size_t keepColor = gray ? 1 : 3;
+    const size_t outChannels = keepColor + (channels == 4 && !dropAlpha ? 1 : 0);
+
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* row = src + y * srcStride;
+        uint8_t* out = dst + y * width * outChannels;
+        size_t p = 0;
+#if BMP_HAVE_SSE2
+        // 4 通道只留灰度：取每个 32 位像素的低字节后两级打包
+        if (channels == 4 && outChannels == 1) {
+            const __m128i lowByte = _mm_set1_epi32(0xFF);
+            for (; p + 16 <= width; p += 16) {
+                const __m128i a = _mm_and_si128(loadu(row + p * 4), lowByte);
+                const __m128i b = _mm_and_si128(loadu(row + p * 4 + 16), lowByte);
+                const __m128i c = _mm_and_si128(loadu(row + p * 4 + 32), lowByte);
+                const __m128i d = _mm_and_si128(loadu(row + p * 4 + 48), lowByte);
+                storeu(out + p, _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+            }
+        }
+#endif
+        for (; p < width; ++p) {
+            const uint8_t* px = row + p * channels;
+            uint8_t* o = out + p * outChannels;
+            for (size_t k = 0; k < keepColor; ++k) o[k] = px[k];
+            if (outChannels > keepColor) o[keepColor] = px[3];
+        }
+    }
+}
+
+void restoreChannels(const uint8_t* src, size_t width, size_t rows, size_t channels, uint8_t redundant,
+                     uint8_t alpha, uint8_t* dst, size_t dstStride) {
+    const bool gray = (redundant & REDUNDANT_GRAY) != 0;
+    const bool dropAlpha = channels == 4 && (redundant & REDUNDANT_ALPHA) != 0;
+    const size_t keepColor = gray ? 1 : 3;
+    const size_t inChannels = keepColor + (channels == 4 && !dropAlpha ? 1 : 0);
+
+    for (size_t y = 0; y < rows; ++y) {
+        const uint8_t* in = src + y * width * inChannels;
+        uint8_t* out = dst + y * dstStride;
+        size_t p = 0;
+#if BMP_HAVE_SSE2
+        // 灰度 + 常量 Alpha 展开为 4 通道：(g,g) 与 (g,a) 两组字节对再按 16 位交织
+        if (channels == 4 && inChannels == 1) {
+            const __m128i alphaVec = _mm_set1_epi8(static_cast<char>(alpha));
+            for (; p + 16 <= width; p += 16) {
+                const __m128i g = loadu(in + p);
+                const __m128i gg0 = _mm_unpacklo_epi8(g, g);
+                const __m128i gg1 = _mm_unpackhi_epi8(g, g);
+                const __m128i ga0 = _mm_unpacklo_epi8(g, alphaVec);
+                const __m128i ga1 = _mm_unpackhi_epi8(g, alphaVec);
+                storeu(out + p * 4, _mm_unpacklo_epi16(gg0, ga0));
+                storeu(out + p * 4 + 16, _mm_unpackhi_epi16(gg0, ga0));
+                storeu(out + p * 4 + 32, _mm_unpacklo_epi16(gg1, ga1));
+                storeu(out + p * 4 + 48, _mm_unpackhi_epi16(gg1, ga1));
+            }
+        }
+#endif
+        for (; p < width; ++p) {
+            const uint8_t* px = in + p * inChannels;
+            uint8_t* o = out + p * channels;
+            if (gray) {
+                o[0] = o[1] = o[2] = px[0];
+            } else {
+                o[0] = px[0];
+                o[1] = px[1];
+                o[2] = px[2];
+            }
+            if (channels == 4) o[3] = dropAlpha ? alpha : px[keepColor];
+        }
+    }
+}
+
+void subtractFrame(const uint8_t* cur, const uint8_t* prev, size_t count, size_t sampleBytes, uint8_t* dst) {
+    size_t i = 0;
+    if (sampleBytes == 2) {
+#if BMP_HAVE_SSE2
+        for (; i + 16 <= count; i += 16) {
+            storeu(dst + i, _mm_sub_epi16(loadu(cur + i), loadu(prev + i)));
+        }
+#endif
+        for (; i + 2 <= count; i += 2) {
+            const uint16_t a = static_cast<uint16_t>(cur[i] | (cur[i + 1] << 8));
+            const uint16_t b = static_cast<uint16_t>(prev[i] | (prev[i + 1] << 8));
+            const uint16_t d = static_cast<uint16_t>(a - b);
+            dst[i] = static_cast<uint8_t>(d);
+            dst[i + 1] = static_cast<uint8_t>(d >> 8);
+        }
+    }
+#if BMP_HAVE_SSE2
+    for (; i + 16 <= count; i += 16) {
+        storeu(dst + i, _mm_sub_epi8(loadu(cur + i), loadu(prev + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+    }
+}
+
+void addFrame(uint8_t* dst, const uint8_t* prev, size_t count, size_t sampleBytes) {
+    size_t i = 0;
+    if (sampleBytes == 2) {
+#if BMP_HAVE_SSE2
+        for (; i + 16 <= count; i += 16) {
+            storeu(dst + i, _mm_add_epi16(loadu(dst + i), loadu(prev + i)));
+        }
+#endif
+        for (; i + 2 <= count; i += 2) {
+            const uint16_t a = static_cast<uint16_t>(dst[i] | (dst[i + 1] << 8));
+            const uint16_t b = static_cast<uint16_t>(prev[i] | (prev[i + 1] << 8));
+            const uint16_t sum = static_cast<uint16_t>(a + b);
+            dst[i] = static_cast<uint8_t>(sum);
+            dst[i + 1] = static_cast<uint8_t>(sum >> 8);
+        }
+    }
+#if BMP_HAVE_SSE2
+    for (; i + 16 <= count; i += 16) {
+        storeu(dst + i, _mm_add_epi8(loadu(dst + i), loadu(prev + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[i] = static_cast<uint8_t>(dst[i] + prev[i]);
+    }
+}
+
+void shuffleBits(const uint8_t* src, size_t count, uint8_t* dst) {
+    const size_t planeBytes = count / 8;
+    size_t i = 0;
+#if BMP_HAVE_SSE2
+    // movemask 一次取出 16 个字节的最高位，左移后依次得到第 7..0 位平面
+    for (; i + 16 <= planeBytes * 8; i += 16) {
+        __m128i v = loadu(src + i);
+        for (int bit = 7; bit >= 0; --bit) {
+            const int mask = _mm_movemask_epi8(v);
+            uint8_t* plane = dst + bit * planeBytes + i / 8;
+            plane[0] = static_cast<uint8_t>(mask);
+            plane[1] = static_cast<uint8_t>(mask >> 8);
+            v = _mm_add_epi8(v, v);
+        }
+    }
+#endif
+    for (; i < planeBytes * 8; i += 8) {
+        const uint64_t bits = transpose8x8(loadLE64(src + i));
+        for (size_t bit = 0; bit < 8; ++bit) {
+            dst[bit * planeBytes + i / 8] = static_cast<uint8_t>(bits >> (bit * 8));
+        }
+    }
+    std::memcpy(dst + i, src + i, count - i);
+}
+
+void unshuffleBits(const uint8_t* src, size_t count, uint8_t* dst) {
+    const size_t planeBytes = count / 8;
+    size_t i = 0;
+    for (; i < planeBytes * 8; i += 8) {
+        uint64_t bits = 0;
+        for (size_t bit = 0; bit < 8; ++bit) {
+            bits |= static_cast<uint64_t>(src[bit * planeBytes + i / 8]) << (bit * 8);
+        }
+        storeLE64(dst + i, transpose8x8(bits));
+    }
+    std::memcpy(dst + i, src + i, count - i);
+}
+
+} // namespace detail
+} // namespace zstd_compressor
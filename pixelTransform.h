@@ -0,0 +1,56 @@
+#ifndef PIXELTRANSFORM_H
+#define PIXELTRANSFORM_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 交织像素拆分为通道平面：planes[k] 接收第 k 个通道的 pixels 个样本
+    void splitChannels(const uint8_t* src, size_t pixels, size_t channels, uint8_t* const* planes);
+    // splitChannels 的逆过程
+    void mergeChannels(const uint8_t* const* planes, size_t pixels, size_t channels, uint8_t* dst);
+
+    // 整幅图像的平面化：src 为按 srcStride 排列的 rows 行交织像素，
+    // dst 依次存放各通道平面，每个平面 rows 行、每行 width 字节
+    void deinterleaveImage(const uint8_t* src, size_t srcStride, size_t width, size_t rows,
+                           size_t channels, uint8_t* dst);
+    void interleaveImage(const uint8_t* src, size_t width, size_t rows, size_t channels,
+                         uint8_t* dst, size_t dstStride);
+
+    // 冗余通道：前三个通道相等（灰度存成彩色）、第 4 个通道为常量（不透明 Alpha / RGB32 填充字节）
+    enum RedundantChannel : uint8_t {
+        REDUNDANT_NONE = 0,
+        REDUNDANT_GRAY = 1u << 0,
+        REDUNDANT_ALPHA = 1u << 1
+    };
+
+    // 扫描 3/4 通道像素的冗余通道，两种冗余都被排除后立即返回；alpha 返回常量通道的值
+    uint8_t scanRedundantChannels(const uint8_t* src, size_t srcStride, size_t width, size_t rows,
+                                  size_t channels, uint8_t& alpha);
+    // 去掉冗余通道后紧凑存储：灰度只保留第 0 通道，常量 Alpha 整体去掉
+    void dropChannels(const uint8_t* src, size_t srcStride, size_t width, size_t rows, size_t channels,
+                      uint8_t redundant, uint8_t* dst);
+    void restoreChannels(const uint8_t* src, size_t width, size_t rows, size_t channels, uint8_t redundant,
+                         uint8_t alpha, uint8_t* dst, size_t dstStride);
+
+    // 帧间差分：dst = cur - prev，addFrame 为其逆过程 dst += prev。sampleBytes 为 1 时按字节取模，
+    // 为 2 时按小端 16 位样本取模，低字节的借位进入高字节，缓慢变化的 16 位数据差分后高字节接近 0
+    void subtractFrame(const uint8_t* cur, const uint8_t* prev, size_t count, size_t sampleBytes, uint8_t* dst);
+    void addFrame(uint8_t* dst, const uint8_t* prev, size_t count, size_t sampleBytes);
+
+    // 位混洗：把 count 字节拆成 8 个位平面（第 k 个平面存放各字节的第 k 位，每平面 count / 8 字节），
+    // 不足 8 字节的尾部原样放在最后
+    void shuffleBits(const uint8_t* src, size_t count, uint8_t* dst);
+    void unshuffleBits(const uint8_t* src, size_t count, uint8_t* dst);
+
+    // 无损 YCoCg-R（按 8 位取模的提升实现，Co/Cg 的移位按有符号字节处理）
+    // 正变换后 r 平面存 Co，g 平面存 Y，b 平面存 Cg
+    void forwardYCoCgR(uint8_t* r, uint8_t* g, uint8_t* b, size_t count);
+    void inverseYCoCgR(uint8_t* r, uint8_t* g, uint8_t* b, size_t count);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // PIXELTRANSFORM_H
@@ -0,0 +1,633 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "rawImage.h"
+#include "byteOrder.h"
+#include "pixelFilter.h"
+#include "pixelPalette.h"
+#include "pixelTiles.h"
+#include "pixelTransform.h"
+#define XXH_STATIC_LINKING_ONLY
+#include "xxhash.h"
+#include <algorithm>
+#include <cstring>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr unsigned char kRawTag[4] = { 'Z', 'B', 'M', 'R' };
+// 版本 2 在版本 1 的 24 字节之后追加 LE64 像素校验和
+constexpr unsigned char kRawVersion = 2;
+constexpr unsigned char kRawVersionNoChecksum = 1;
+constexpr size_t kRawHeaderBodySize = 32;
+constexpr size_t kRawHeaderBodySizeNoChecksum = 24;
+constexpr uint32_t kSupportedTransforms = TRANSFORM_ROW_FILTER | TRANSFORM_PLANAR | TRANSFORM_YCOCG_R
+                                        | TRANSFORM_BYTE_SHUFFLE | TRANSFORM_BIT_SHUFFLE | TRANSFORM_TILE_FILTER
+                                        | TRANSFORM_PALETTE | TRANSFORM_CHANNEL_REDUCE | TRANSFORM_CONSTANT_TILES;
+constexpr uint32_t kFilterTransforms = TRANSFORM_ROW_FILTER | TRANSFORM_TILE_FILTER;
+// 分块滤波的块大小（像素 x 行），payload 前 4 字节记录实际使用的块字节宽度和行数
+constexpr size_t kFilterTilePixels = 64;
+constexpr size_t kFilterTileRows = 64;
+constexpr size_t kTilePrefixSize = 4;
+// 冗余通道消除在 payload 末尾追加 2 字节：冗余标志、常量 Alpha 值
+constexpr size_t kReduceSuffixSize = 2;
+// 常量块检测的块大小；payload 末尾依次为 常量块像素值 | 块位图 | LE16 块宽（像素）| LE16 块行数
+constexpr size_t kConstantTilePixels = 64;
+constexpr size_t kConstantTileRows = 64;
+constexpr size_t kConstantTileSuffixSize = 4;
+
+// 经过通道重排后送入滤波器的行结构
+struct RowLayout {
+    size_t rows;
+    size_t rowBytes;
+    size_t bpp;
+};
+
+size_t bytesPerSample(const RawImageInfo& info) {
+    return (info.depth + 7) / 8;
+}
+
+// 字节混洗后每个字节流按一幅 8 位图像处理，行数乘以样本字节数
+RowLayout rowLayout(const RawImageInfo& info) {
+    const size_t imageRows = (info.transforms & TRANSFORM_BYTE_SHUFFLE)
+        ? static_cast<size_t>(info.height) * bytesPerSample(info) : info.height;
+    if (info.transforms & TRANSFORM_PLANAR) {
+        return { imageRows * info.channels, info.width, 1 };
+    }
+    if (info.transforms & TRANSFORM_BYTE_SHUFFLE) {
+        return { imageRows, static_cast<size_t>(info.width) * info.channels, info.channels };
+    }
+    return { info.height, info.stride, bytesPerPixel(info) };
+}
+
+// 颜色变换需要的 R/B 通道位置（G 总在 1 号通道），灰度等格式返回 false
+bool colorChannelOrder(PixelFormat format, size_t& rIndex, size_t& bIndex) {
+    switch (format) {
+        case PixelFormat::PIXEL_BGR888:
+        case PixelFormat::PIXEL_BGRA8888:
+        case PixelFormat::PIXEL_BGRX8888:
+            rIndex = 2;
+            bIndex = 0;
+            return true;
+        case PixelFormat::PIXEL_RGB888:
+        case PixelFormat::PIXEL_RGBA8888:
+            rIndex = 0;
+            bIndex = 2;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void applyColorTransform(const RawImageInfo& info, unsigned char* planes, bool forward) {
+    size_t rIndex = 0;
+    size_t bIndex = 0;
+    colorChannelOrder(info.format, rIndex, bIndex);
+    const size_t planeSize = static_cast<size_t>(info.width) * info.height;
+    unsigned char* r = planes + rIndex * planeSize;
+    unsigned char* g = planes + planeSize;
+    unsigned char* b = planes + bIndex * planeSize;
+    if (forward) {
+        forwardYCoCgR(r, g, b, planeSize);
+    } else {
+        inverseYCoCgR(r, g, b, planeSize);
+    }
+}
+
+// 变换组合约束：调色板独占；平面化和颜色变换按字节操作，多字节样本必须先做字节混洗；
+// 位混洗只能接在字节混洗之后，且不与平面化、滤波叠加
+bool transformsValid(const RawImageInfo& info) {
+    const uint32_t transforms = info.transforms;
+    if (transforms & ~kSupportedTransforms) return false;
+    if (transforms & TRANSFORM_PALETTE) return transforms == TRANSFORM_PALETTE && supportsPalette(info);
+    if ((transforms & TRANSFORM_CHANNEL_REDUCE) && !supportsChannelReduction(info)) return false;
+    if ((transforms & TRANSFORM_YCOCG_R) && !supportsColorTransform(info)) return false;
+    if ((transforms & TRANSFORM_PLANAR) && bytesPerSample(info) > 1 && !(transforms & TRANSFORM_BYTE_SHUFFLE)) {
+        return false;
+    }
+    if ((transforms & TRANSFORM_BYTE_SHUFFLE) && info.stride != info.width * bytesPerPixel(info)) return false;
+    if (transforms & TRANSFORM_BIT_SHUFFLE) {
+        if (!(transforms & TRANSFORM_BYTE_SHUFFLE)) return false;
+        if (transforms & (TRANSFORM_PLANAR | kFilterTransforms)) return false;
+    }
+    return (transforms & kFilterTransforms) != kFilterTransforms;
+}
+
+// 去掉冗余通道后的图像描述；随通道数失效的变换一并去掉
+RawImageInfo reducedInfo(const RawImageInfo& info, uint8_t redundant) {
+    RawImageInfo reduced = info;
+    reduced.transforms &= ~static_cast<uint32_t>(TRANSFORM_CHANNEL_REDUCE);
+    if (redundant == REDUNDANT_NONE) return reduced;
+
+    const bool gray = (redundant & REDUNDANT_GRAY) != 0;
+    const bool keepAlpha = info.channels == 4 && !(redundant & REDUNDANT_ALPHA);
+    reduced.channels = static_cast<uint8_t>((gray ? 1 : 3) + (keepAlpha ? 1 : 0));
+    if (gray) {
+        reduced.format = keepAlpha ? PixelFormat::PIXEL_UNKNOWN : PixelFormat::PIXEL_GRAY8;
+    } else if (!keepAlpha) {
+        reduced.format = info.format == PixelFormat::PIXEL_RGBA8888 ? PixelFormat::PIXEL_RGB888
+                                                                   : PixelFormat::PIXEL_BGR888;
+    }
+    reduced.stride = static_cast<uint32_t>(reduced.width * bytesPerPixel(reduced));
+    if (!supportsColorTransform(reduced)) reduced.transforms &= ~static_cast<uint32_t>(TRANSFORM_YCOCG_R);
+    if (reduced.channels == 1) reduced.transforms &= ~static_cast<uint32_t>(TRANSFORM_PLANAR);
+    return reduced;
+}
+
+// 去掉常量块后剩余块横向拼接成的图像
+RawImageInfo residualInfo(const RawImageInfo& info, size_t tileWidth, size_t tileRows, size_t tiles) {
+    RawImageInfo residual = info;
+    residual.transforms &= ~static_cast<uint32_t>(TRANSFORM_CONSTANT_TILES);
+    residual.width = static_cast<uint32_t>(tileWidth * tiles);
+    residual.height = static_cast<uint32_t>(tileRows);
+    residual.stride = static_cast<uint32_t>(residual.width * bytesPerPixel(info));
+    return residual;
+}
+
+size_t popcount(const unsigned char* bitmap, size_t size) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; ++i) {
+        for (unsigned bits = bitmap[i]; bits; bits &= bits - 1) ++count;
+    }
+    return count;
+}
+
+// 常量块 payload 末尾的解析结果；body 为剩余块组成的图像（没有常量块时就是原图）
+struct ConstantTiles {
+    size_t tileWidth = 0;
+    size_t tileRows = 0;
+    size_t count = 0;
+    size_t constant = 0;
+    const unsigned char* bitmap = nullptr;
+    const unsigned char* fills = nullptr;
+    size_t bodySize = 0;
+    RawImageInfo body;
+};
+
+bool parseConstantTiles(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                        ConstantTiles& tiles) {
+    if (payloadSize < kConstantTileSuffixSize) return false;
+    tiles.tileWidth = readLE16(payload + payloadSize - 4);
+    tiles.tileRows = readLE16(payload + payloadSize - 2);
+    if (tiles.tileWidth == 0 || tiles.tileRows == 0) return false;
+
+    tiles.count = constantTileCount(info.width, info.height, tiles.tileWidth, tiles.tileRows);
+    const size_t bitmapSize = (tiles.count + 7) / 8;
+    if (payloadSize - kConstantTileSuffixSize < bitmapSize) return false;
+    tiles.bitmap = payload + payloadSize - kConstantTileSuffixSize - bitmapSize;
+    tiles.constant = popcount(tiles.bitmap, bitmapSize);
+    if (tiles.constant > tiles.count) return false;
+    const size_t fillSize = tiles.constant * bytesPerPixel(info);
+    if (payloadSize - kConstantTileSuffixSize - bitmapSize < fillSize) return false;
+    tiles.fills = tiles.bitmap - fillSize;
+    tiles.bodySize = static_cast<size_t>(tiles.fills - payload);
+
+    if (tiles.constant == 0) {
+        tiles.body = info;
+        tiles.body.transforms &= ~static_cast<uint32_t>(TRANSFORM_CONSTANT_TILES);
+    } else {
+        tiles.body = residualInfo(info, tiles.tileWidth, tiles.tileRows, tiles.count - tiles.constant);
+    }
+    return true;
+}
+
+size_t tileBytes(const RowLayout& layout) {
+    return kFilterTilePixels * layout.bpp;
+}
+
+// payload 大小：逐行滤波每行多 1 字节类型，分块滤波在前部放置块大小和滤波映射表
+size_t expectedPayloadSize(const RawImageInfo& info, const RowLayout& layout) {
+    const size_t body = layout.rows * layout.rowBytes;
+    if (info.transforms & TRANSFORM_ROW_FILTER) return body + layout.rows;
+    if (info.transforms & TRANSFORM_TILE_FILTER) {
+        return body + kTilePrefixSize + tileCount(layout.rows, layout.rowBytes, tileBytes(layout), kFilterTileRows);
+    }
+    return body;
+}
+
+void filterPayload(const RawImageInfo& info, const RowLayout& layout, const unsigned char* rows,
+                   size_t rowStride, unsigned char* payload) {
+    if (info.transforms & TRANSFORM_ROW_FILTER) {
+        filterRows(rows, rowStride, layout.rows, layout.rowBytes, layout.bpp, payload);
+        return;
+    }
+    const size_t tileWidth = tileBytes(layout);
+    const size_t tiles = tileCount(layout.rows, layout.rowBytes, tileWidth, kFilterTileRows);
+    writeLE16(payload, static_cast<uint32_t>(tileWidth));
+    writeLE16(payload + 2, static_cast<uint32_t>(kFilterTileRows));
+    filterTiles(rows, rowStride, layout.rows, layout.rowBytes, layout.bpp, tileWidth, kFilterTileRows,
+                payload + kTilePrefixSize, payload + kTilePrefixSize + tiles);
+}
+
+bool unfilterPayload(const RawImageInfo& info, const RowLayout& layout, const unsigned char* payload,
+                     size_t payloadSize, unsigned char* dst, size_t dstStride) {
+    if (info.transforms & TRANSFORM_ROW_FILTER) {
+        return unfilterRows(payload, layout.rows, layout.rowBytes, layout.bpp, dst, dstStride);
+    }
+    // 块大小以 payload 中记录的为准，并与总大小交叉校验
+    const size_t tileWidth = readLE16(payload);
+    const size_t tileRows = readLE16(payload + 2);
+    if (tileWidth == 0 || tileRows == 0 || tileWidth % layout.bpp != 0) return false;
+    const size_t tiles = tileCount(layout.rows, layout.rowBytes, tileWidth, tileRows);
+    if (payloadSize != kTilePrefixSize + tiles + layout.rows * layout.rowBytes) return false;
+    return unfilterTiles(payload + kTilePrefixSize, payload + kTilePrefixSize + tiles, layout.rows,
+                         layout.rowBytes, layout.bpp, tileWidth, tileRows, dst, dstStride);
+}
+
+} // namespace
+
+size_t bytesPerPixel(const RawImageInfo& info) {
+    return static_cast<size_t>(info.channels) * ((info.depth + 7) / 8);
+}
+
+size_t writeRawHeader(const RawImageInfo& info, std::vector<unsigned char>& out) {
+    unsigned char body[kRawHeaderBodySize];
+    std::memcpy(body, kRawTag, sizeof(kRawTag));
+    body[4] = kRawVersion;
+    body[5] = static_cast<unsigned char>(info.format);
+    body[6] = info.channels;
+    body[7] = info.depth;
+    writeLE32(body + 8, info.width);
+    writeLE32(body + 12, info.height);
+    writeLE32(body + 16, info.stride);
+    writeLE32(body + 20, info.transforms);
+    writeLE64(body + 24, info.checksum);
+
+    const size_t offset = out.size();
+    out.resize(offset + kSkippableHeaderSize + sizeof(body));
+    const size_t written = ZSTD_writeSkippableFrame(out.data() + offset, out.size() - offset,
+                                                    body, sizeof(body), kRawHeaderMagicVariant);
+    if (ZSTD_isError(written)) {
+        out.resize(offset);
+        return 0;
+    }
+    out.resize(offset + written);
+    return written;
+}
+
+bool isRawImageFrame(const unsigned char* src, size_t size) {
+    if (size < kSkippableHeaderSize + sizeof(kRawTag)) return false;
+    if (readLE32(src) != ZSTD_MAGIC_SKIPPABLE_START + kRawHeaderMagicVariant) return false;
+    return std::memcmp(src + kSkippableHeaderSize, kRawTag, sizeof(kRawTag)) == 0;
+}
+
+bool readRawHeader(const unsigned char* src, size_t size, RawImageInfo& info, size_t& headerSize) {
+    if (!isRawImageFrame(src, size)) return false;
+
+    const size_t frameSize = ZSTD_findFrameCompressedSize(src, size);
+    if (ZSTD_isError(frameSize) || frameSize < kSkippableHeaderSize + kRawHeaderBodySizeNoChecksum) return false;
+
+    const unsigned char* body = src + kSkippableHeaderSize;
+    const bool hasChecksum = body[4] == kRawVersion;
+    if (!hasChecksum && body[4] != kRawVersionNoChecksum) return false;
+    if (hasChecksum && frameSize < kSkippableHeaderSize + kRawHeaderBodySize) return false;
+
+    RawImageInfo parsed;
+    parsed.format = static_cast<PixelFormat>(body[5]);
+    parsed.channels = body[6];
+    parsed.depth = body[7];
+    parsed.width = readLE32(body + 8);
+    parsed.height = readLE32(body + 12);
+    parsed.stride = readLE32(body + 16);
+    parsed.transforms = readLE32(body + 20);
+    if (hasChecksum) {
+        parsed.checksum = readLE64(body + 24);
+    }
+
+    if (!parsed.valid() || parsed.stride < parsed.width * bytesPerPixel(parsed)) return false;
+
+    info = parsed;
+    headerSize = frameSize;
+    return true;
+}
+
+uint64_t pixelChecksum(const unsigned char* pixels, size_t stride, size_t rowBytes, size_t rows) {
+    if (stride == rowBytes) return XXH64(pixels, rowBytes * rows, 0);
+    XXH64_state_t state;
+    XXH64_reset(&state, 0);
+    for (size_t y = 0; y < rows; ++y) {
+        XXH64_update(&state, pixels + y * stride, rowBytes);
+    }
+    return XXH64_digest(&state);
+}
+
+bool supportsColorTransform(const RawImageInfo& info) {
+    size_t rIndex = 0;
+    size_t bIndex = 0;
+    return info.depth == 8 && colorChannelOrder(info.format, rIndex, bIndex);
+}
+
+bool supportsPalette(const RawImageInfo& info) {
+    return info.depth == 8 && info.channels <= 4;
+}
+
+bool supportsChannelReduction(const RawImageInfo& info) {
+    return info.depth == 8 && info.channels >= 3 && supportsColorTransform(info);
+}
+
+bool encodeRawPayload(const RawImageInfo& info, const unsigned char* pixels, size_t pixelStride,
+                      std::vector<unsigned char>& payload) {
+    if (!transformsValid(info)) return false;
+    if (info.transforms & TRANSFORM_CHANNEL_REDUCE) {
+        // 冗余通道先去掉，剩余通道按其它变换继续编码
+        uint8_t alpha = 0;
+        const uint8_t redundant = scanRedundantChannels(pixels, pixelStride, info.width, info.height,
+                                                        info.channels, alpha);
+        const RawImageInfo reduced = reducedInfo(info, redundant);
+        bool encoded = false;
+        if (redundant == REDUNDANT_NONE) {
+            encoded = encodeRawPayload(reduced, pixels, pixelStride, payload);
+        } else {
+            std::vector<unsigned char> kept(reduced.dataSize());
+            dropChannels(pixels, pixelStride, info.width, info.height, info.channels, redundant, kept.data());
+            encoded = encodeRawPayload(reduced, kept.data(), reduced.stride, payload);
+        }
+        if (!encoded) return false;
+        payload.push_back(redundant);
+        payload.push_back(alpha);
+        return true;
+    }
+    if (info.transforms & TRANSFORM_CONSTANT_TILES) {
+        // 常量块只记录像素值，其余块堆叠后按其它变换继续编码；没有常量块时按原图编码
+        const size_t bpp = bytesPerPixel(info);
+        const size_t tileWidth = std::min<size_t>(kConstantTilePixels, info.width);
+        const size_t tileRows = std::min<size_t>(kConstantTileRows, info.height);
+        const size_t tiles = constantTileCount(info.width, info.height, tileWidth, tileRows);
+        std::vector<unsigned char> bitmap((tiles + 7) / 8);
+        std::vector<unsigned char> fills;
+        const size_t constant = scanConstantTiles(pixels, pixelStride, info.width, info.height, bpp,
+                                                  tileWidth, tileRows, bitmap.data(), fills);
+        if (constant == 0) {
+            RawImageInfo body = info;
+            body.transforms &= ~static_cast<uint32_t>(TRANSFORM_CONSTANT_TILES);
+            if (!encodeRawPayload(body, pixels, pixelStride, payload)) return false;
+        } else if (constant < tiles) {
+            const RawImageInfo body = residualInfo(info, tileWidth, tileRows, tiles - constant);
+            std::vector<unsigned char> packed(body.dataSize());
+            packTiles(pixels, pixelStride, info.width, info.height, bpp, tileWidth, tileRows,
+                      bitmap.data(), packed.data(), body.stride);
+            if (!encodeRawPayload(body, packed.data(), body.stride, payload)) return false;
+        } else {
+            payload.clear();
+        }
+
+        unsigned char sizes[kConstantTileSuffixSize];
+        writeLE16(sizes, static_cast<uint32_t>(tileWidth));
+        writeLE16(sizes + 2, static_cast<uint32_t>(tileRows));
+        payload.insert(payload.end(), fills.begin(), fills.end());
+        payload.insert(payload.end(), bitmap.begin(), bitmap.end());
+        payload.insert(payload.end(), sizes, sizes + kConstantTileSuffixSize);
+        return true;
+    }
+    if (info.transforms & TRANSFORM_PALETTE) {
+        return encodePalette(pixels, pixelStride, info.width, info.height, bytesPerPixel(info), payload);
+    }
+
+    const RowLayout layout = rowLayout(info);
+    const bool planar = (info.transforms & TRANSFORM_PLANAR) != 0;
+    const bool color = (info.transforms & TRANSFORM_YCOCG_R) != 0;
+    const bool filtered = (info.transforms & kFilterTransforms) != 0;
+    const bool byteShuffled = (info.transforms & TRANSFORM_BYTE_SHUFFLE) != 0;
+    const bool bitShuffled = (info.transforms & TRANSFORM_BIT_SHUFFLE) != 0;
+
+    payload.resize(expectedPayloadSize(info, layout));
+
+    // 第一步：字节混洗，把多字节样本拆成按字节序排列的若干 8 位图像
+    const unsigned char* rows = pixels;
+    size_t rowStride = pixelStride;
+    size_t imageRows = info.height;
+    std::vector<unsigned char> shuffled;
+    if (byteShuffled) {
+        const size_t samples = static_cast<size_t>(info.width) * info.channels;
+        const size_t sampleBytes = bytesPerSample(info);
+        unsigned char* target = payload.data();
+        if (filtered || planar || bitShuffled) {
+            shuffled.resize(info.dataSize());
+            target = shuffled.data();
+        }
+        deinterleaveImage(pixels, pixelStride, samples, info.height, sampleBytes, target);
+        if (bitShuffled) {
+            const size_t streamSize = samples * info.height;
+            for (size_t k = 0; k < sampleBytes; ++k) {
+                shuffleBits(target + k * streamSize, streamSize, payload.data() + k * streamSize);
+            }
+            return true;
+        }
+        if (target == payload.data()) return true;
+
+        rows = target;
+        rowStride = samples;
+        imageRows = info.height * sampleBytes;
+    }
+
+    // 第二步：通道拆分 / 颜色变换，得到待滤波的紧凑行；不滤波时直接写入 payload
+    std::vector<unsigned char> planes;
+    std::vector<unsigned char> staging;
+    if (planar || color) {
+        unsigned char* planeData = payload.data();
+        if (filtered || !planar) {
+            planes.resize(info.dataSize());
+            planeData = planes.data();
+        }
+        deinterleaveImage(rows, rowStride, info.width, imageRows, info.channels, planeData);
+        if (color) applyColorTransform(info, planeData, true);
+
+        if (planar) {
+            rows = planeData;
+            rowStride = layout.rowBytes;
+        } else {
+            unsigned char* interleaved = payload.data();
+            if (filtered) {
+                staging.resize(info.dataSize());
+                interleaved = staging.data();
+            }
+            interleaveImage(planeData, info.width, imageRows, info.channels, interleaved, layout.rowBytes);
+            rows = interleaved;
+            rowStride = layout.rowBytes;
+        }
+        if (!filtered) return true;
+    } else if (!filtered) {
+        packRows(rows, rowStride, payload.data(), layout.rowBytes, layout.rows);
+        return true;
+    }
+
+    // 第三步：预测滤波（逐行或分块）
+    filterPayload(info, layout, rows, rowStride, payload.data());
+    return true;
+}
+
+bool decodeRawPayload(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                      unsigned char* pixels, size_t pixelStride) {
+    if (!transformsValid(info)) return false;
+    if (info.transforms & TRANSFORM_CHANNEL_REDUCE) {
+        if (payloadSize < kReduceSuffixSize) return false;
+        const uint8_t redundant = payload[payloadSize - 2];
+        const uint8_t alpha = payload[payloadSize - 1];
+        if (redundant & ~(REDUNDANT_GRAY | REDUNDANT_ALPHA)) return false;
+        if ((redundant & REDUNDANT_ALPHA) && info.channels != 4) return false;
+
+        const RawImageInfo reduced = reducedInfo(info, redundant);
+        const size_t bodySize = payloadSize - kReduceSuffixSize;
+        if (redundant == REDUNDANT_NONE) return decodeRawPayload(reduced, payload, bodySize, pixels, pixelStride);
+
+        std::vector<unsigned char> kept(reduced.dataSize());
+        if (!decodeRawPayload(reduced, payload, bodySize, kept.data(), reduced.stride)) return false;
+        restoreChannels(kept.data(), info.width, info.height, info.channels, redundant, alpha, pixels, pixelStride);
+        return true;
+    }
+    if (info.transforms & TRANSFORM_CONSTANT_TILES) {
+        ConstantTiles tiles;
+        if (!parseConstantTiles(info, payload, payloadSize, tiles)) return false;
+        if (tiles.constant == tiles.count) {
+            if (tiles.bodySize != 0) return false;
+        } else if (tiles.constant == 0) {
+            return decodeRawPayload(tiles.body, payload, tiles.bodySize, pixels, pixelStride);
+        }
+
+        std::vector<unsigned char> packed(tiles.constant < tiles.count ? tiles.body.dataSize() : 0);
+        if (!packed.empty() && !decodeRawPayload(tiles.body, payload, tiles.bodySize, packed.data(), tiles.body.stride)) {
+            return false;
+        }
+        unpackTiles(packed.data(), tiles.body.stride, tiles.fills, info.width, info.height, bytesPerPixel(info),
+                    tiles.tileWidth, tiles.tileRows, tiles.bitmap, pixels, pixelStride);
+        return true;
+    }
+    if (info.transforms & TRANSFORM_PALETTE) {
+        return decodePalette(payload, payloadSize, info.width, info.height, bytesPerPixel(info),
+                             pixels, pixelStride);
+    }
+
+    const RowLayout layout = rowLayout(info);
+    const bool planar = (info.transforms & TRANSFORM_PLANAR) != 0;
+    const bool color = (info.transforms & TRANSFORM_YCOCG_R) != 0;
+    const bool filtered = (info.transforms & kFilterTransforms) != 0;
+    const bool byteShuffled = (info.transforms & TRANSFORM_BYTE_SHUFFLE) != 0;
+    const bool bitShuffled = (info.transforms & TRANSFORM_BIT_SHUFFLE) != 0;
+    // 分块滤波的块大小记录在 payload 中，大小在反滤波时校验
+    if (info.transforms & TRANSFORM_TILE_FILTER) {
+        if (payloadSize < kTilePrefixSize) return false;
+    } else if (payloadSize != expectedPayloadSize(info, layout)) {
+        return false;
+    }
+
+    // 字节混洗时先还原到中间缓冲，最后再交织回目标像素
+    const size_t samples = static_cast<size_t>(info.width) * info.channels;
+    const size_t sampleBytes = bytesPerSample(info);
+    unsigned char* target = pixels;
+    size_t targetStride = pixelStride;
+    size_t imageRows = info.height;
+    std::vector<unsigned char> shuffled;
+    if (byteShuffled) {
+        if (bitShuffled) {
+            const size_t streamSize = samples * info.height;
+            shuffled.resize(info.dataSize());
+            for (size_t k = 0; k < sampleBytes; ++k) {
+                unshuffleBits(payload + k * streamSize, streamSize, shuffled.data() + k * streamSize);
+            }
+            interleaveImage(shuffled.data(), samples, info.height, sampleBytes, pixels, pixelStride);
+            return true;
+        }
+        if (!filtered && !planar) {
+            interleaveImage(payload, samples, info.height, sampleBytes, pixels, pixelStride);
+            return true;
+        }
+        shuffled.resize(info.dataSize());
+        target = shuffled.data();
+        targetStride = samples;
+        imageRows = info.height * sampleBytes;
+    }
+
+    // 第一步：反滤波。平面布局得到通道平面，交织布局直接写入目标
+    const unsigned char* planeData = payload;
+    std::vector<unsigned char> planes;
+    if (planar) {
+        if (filtered || color) {
+            planes.resize(info.dataSize());
+            if (filtered) {
+                if (!unfilterPayload(info, layout, payload, payloadSize, planes.data(), layout.rowBytes)) {
+                    return false;
+                }
+            } else {
+                std::memcpy(planes.data(), payload, payloadSize);
+            }
+            planeData = planes.data();
+        }
+    } else {
+        if (filtered) {
+            if (!unfilterPayload(info, layout, payload, payloadSize, target, targetStride)) return false;
+        } else {
+            unpackRows(payload, layout.rowBytes, target, targetStride, layout.rows);
+        }
+        if (color) {
+            planes.resize(info.dataSize());
+            deinterleaveImage(target, targetStride, info.width, imageRows, info.channels, planes.data());
+            planeData = planes.data();
+        }
+    }
+
+    // 第二步：颜色逆变换并交织回目标
+    if (planar || color) {
+        if (color) applyColorTransform(info, planes.data(), false);
+        interleaveImage(planeData, info.width, imageRows, info.channels, target, targetStride);
+    }
+
+    // 第三步：字节流交织回多字节样本
+    if (byteShuffled) {
+        interleaveImage(shuffled.data(), samples, info.height, sampleBytes, pixels, pixelStride);
+    }
+    return true;
+}
+
+bool rawPayloadGeometry(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                        size_t& rowPeriod, size_t& bpp) {
+    if (!transformsValid(info)) return false;
+    if (info.transforms & TRANSFORM_CHANNEL_REDUCE) {
+        if (payloadSize < kReduceSuffixSize) return false;
+        return rawPayloadGeometry(reducedInfo(info, payload[payloadSize - 2]), payload,
+                                  payloadSize - kReduceSuffixSize, rowPeriod, bpp);
+    }
+    if (info.transforms & TRANSFORM_CONSTANT_TILES) {
+        ConstantTiles tiles;
+        if (!parseConstantTiles(info, payload, payloadSize, tiles) || tiles.constant == tiles.count) return false;
+        return rawPayloadGeometry(tiles.body, payload, tiles.bodySize, rowPeriod, bpp);
+    }
+    if (info.transforms & TRANSFORM_PALETTE) {
+        // 索引行按字节对齐，颜色数在 payload 开头
+        if (payloadSize < 2) return false;
+        const size_t colors = readLE16(payload);
+        rowPeriod = (static_cast<size_t>(info.width) * paletteIndexBits(colors) + 7) / 8;
+        bpp = 1;
+        return rowPeriod > 0;
+    }
+    if (info.transforms & TRANSFORM_BIT_SHUFFLE) return false;
+
+    const RowLayout layout = rowLayout(info);
+    rowPeriod = layout.rowBytes + ((info.transforms & TRANSFORM_ROW_FILTER) ? 1 : 0);
+    bpp = layout.bpp;
+    return true;
+}
+
+void packRows(const unsigned char* src, size_t srcStride, unsigned char* dst,
+              size_t rowBytes, size_t rows) {
+    if (srcStride == rowBytes) {
+        std::memcpy(dst, src, rowBytes * rows);
+        return;
+    }
+    for (size_t y = 0; y < rows; ++y) {
+        std::memcpy(dst + y * rowBytes, src + y * srcStride, rowBytes);
+    }
+}
+
+void unpackRows(const unsigned char* src, size_t rowBytes, unsigned char* dst,
+                size_t dstStride, size_t rows) {
+    if (dstStride == rowBytes) {
+        std::memcpy(dst, src, rowBytes * rows);
+        return;
+    }
+    for (size_t y = 0; y < rows; ++y) {
+        std::memcpy(dst + y * dstStride, src + y * rowBytes, rowBytes);
+    }
+}
+
+} // namespace detail
+} // namespace zstd_compressor
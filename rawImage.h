@@ -0,0 +1,57 @@
+#ifndef RAWIMAGE_H
+#define RAWIMAGE_H
+
+#include "zstdBmpCompressor.h"
+
+namespace zstd_compressor {
+namespace detail {
+
+    // RAW 模式头部使用的 zstd 可跳过帧编号（0x184D2A50 + 变体）
+    constexpr unsigned kRawHeaderMagicVariant = 0xB;
+
+    // 每像素字节数
+    size_t bytesPerPixel(const RawImageInfo& info);
+
+    // 将像素头写成一个 zstd 可跳过帧并追加到 out，返回写入的字节数（失败返回 0）
+    size_t writeRawHeader(const RawImageInfo& info, std::vector<unsigned char>& out);
+
+    // 判断数据是否以 RAW 头部帧开始
+    bool isRawImageFrame(const unsigned char* src, size_t size);
+
+    // 解析 RAW 头部帧，headerSize 返回整个可跳过帧的长度
+    bool readRawHeader(const unsigned char* src, size_t size, RawImageInfo& info, size_t& headerSize);
+
+    // 像素内容的 XXH64（只计算每行前 rowBytes 字节，与行填充无关），写入头部供解压后校验
+    uint64_t pixelChecksum(const unsigned char* pixels, size_t stride, size_t rowBytes, size_t rows);
+
+    // 图像是否可以做 YCoCg-R 颜色变换（8 位 3/4 通道彩色格式）
+    bool supportsColorTransform(const RawImageInfo& info);
+
+    // 图像是否可以使用调色板编码（8 位、至多 4 通道；颜色数在编码时检测）
+    bool supportsPalette(const RawImageInfo& info);
+
+    // 图像是否可以做冗余通道消除（8 位 3/4 通道彩色格式）
+    bool supportsChannelReduction(const RawImageInfo& info);
+
+    // 按 info.transforms 对像素（每行间隔 pixelStride 字节）做可逆预处理，得到送入 zstd 的数据；
+    // TRANSFORM_PALETTE 在颜色数超过 256 时提前返回 false
+    bool encodeRawPayload(const RawImageInfo& info, const unsigned char* pixels, size_t pixelStride,
+                          std::vector<unsigned char>& payload);
+    // encodeRawPayload 的逆过程，结果直接写入 pixels；payload 与头部不匹配时返回 false
+    bool decodeRawPayload(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                          unsigned char* pixels, size_t pixelStride);
+
+    // payload 中相邻两行的字节距离和每像素字节数（供按行查找匹配使用），布局无法确定时返回 false
+    bool rawPayloadGeometry(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                            size_t& rowPeriod, size_t& bpp);
+
+    // 按行拷贝像素，去掉（或加上）行填充
+    void packRows(const unsigned char* src, size_t srcStride, unsigned char* dst,
+                  size_t rowBytes, size_t rows);
+    void unpackRows(const unsigned char* src, size_t rowBytes, unsigned char* dst,
+                    size_t dstStride, size_t rows);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // RAWIMAGE_H
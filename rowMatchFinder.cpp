@@ -0,0 +1,203 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "rowMatchFinder.h"
+#include <zstd.h>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+// 重复上一次偏移的匹配编码代价小，最短 4 字节；新偏移至少 6 字节才比字面量划算
+constexpr size_t kMinRepMatch = 4;
+constexpr size_t kMinMatch = 6;
+// 连续没有匹配时逐渐加大步长，噪声区域不逐字节尝试
+constexpr size_t kSkipShift = 6;
+// 匹配字节少于块大小的 1/kFallbackRatio 时交给内置匹配器
+constexpr size_t kFallbackRatio = 8;
+constexpr size_t kCandidateCount = 5;
+// 通用匹配用 6 字节哈希，表中存放相对 hashBase 的位置
+constexpr unsigned kHashLog = 17;
+constexpr size_t kHashBytes = 6;
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t hash6(const unsigned char* p) {
+    return static_cast<uint32_t>(((read64(p) << 16) * 0xCF1BBCDCBF9BULL) >> (64 - kHashLog));
+}
+
+inline unsigned highbit(size_t value) {
+    unsigned bits = 0;
+    while (value >>= 1) ++bits;
+    return bits;
+}
+
+inline size_t trailingZeroBytes(uint64_t diff) {
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(diff)) >> 3;
+#else
+    size_t bytes = 0;
+    while ((diff & 0xFF) == 0) {
+        diff >>= 8;
+        ++bytes;
+    }
+    return bytes;
+#endif
+}
+
+// ip 与 match 的公共前缀长度，ip 不超过 end
+size_t matchLength(const unsigned char* ip, const unsigned char* match, const unsigned char* end) {
+    const unsigned char* const start = ip;
+    while (ip + 8 <= end) {
+        const uint64_t diff = read64(ip) ^ read64(match);
+        if (diff) return static_cast<size_t>(ip - start) + trailingZeroBytes(diff);
+        ip += 8;
+        match += 8;
+    }
+    while (ip < end && *ip == *match) {
+        ++ip;
+        ++match;
+    }
+    return static_cast<size_t>(ip - start);
+}
+
+// 每块的贪心解析：在上一次的偏移、正上方、左上 / 右上、左侧、上两行的像素和哈希表候选中取最长匹配
+size_t rowMatchProducer(void* statePtr, ZSTD_Sequence* outSeqs, size_t outSeqsCapacity,
+                        const void* srcPtr, size_t srcSize, const void* dict, size_t dictSize,
+                        int compressionLevel, size_t windowSize) {
+    (void)dict;
+    (void)dictSize;
+    (void)compressionLevel;
+    RowMatchState& state = *static_cast<RowMatchState*>(statePtr);
+    const unsigned char* const src = static_cast<const unsigned char*>(srcPtr);
+    const unsigned char* const end = src + srcSize;
+    if (srcSize < kHashBytes + 2 || state.rowPeriod == 0) return ZSTD_SEQUENCE_PRODUCER_ERROR;
+
+    // 外部序列生成器拿不到历史数据，匹配只能引用当前块（zstd.h 中外部序列生成器的限制说明）。
+    // 哈希表跨块保留，表中的旧位置只作为候选，越界或不相等的在 tryOffset 中被排除
+    if (state.hashTable.empty()) {
+        state.hashTable.assign(size_t(1) << kHashLog, 0);
+        state.reps[0] = state.rowPeriod;
+        state.reps[1] = state.bpp;
+        state.reps[2] = state.rowPeriod * 2;
+    }
+    uint32_t* const table = state.hashTable.data();
+
+    const size_t stride = state.rowPeriod;
+    const size_t bpp = state.bpp ? state.bpp : 1;
+    const size_t candidates[kCandidateCount] = { stride, stride > bpp ? stride - bpp : 0, stride + bpp, bpp, stride * 2 };
+    size_t* const reps = state.reps;
+
+    size_t nbSeq = 0;
+    size_t matched = 0;
+    const unsigned char* anchor = src;
+    const unsigned char* ip = src;
+    const unsigned char* const hashLimit = end - 8;
+    while (ip < hashLimit) {
+        const size_t position = static_cast<size_t>(ip - src);
+        const uint32_t head = read32(ip);
+        size_t bestLength = 0;
+        size_t bestOffset = 0;
+        int bestScore = 0;
+
+        // 与 zstd 内部解析相同的取舍：每字节记 4 分，减去偏移编码位数（重复偏移只需 1~2 位）
+        auto tryOffset = [&](size_t offset, size_t offBase, size_t minLength) {
+            if (offset == 0 || offset > position || offset > windowSize) return;
+            if (read32(ip - offset) != head) return;
+            const size_t length = matchLength(ip, ip - offset, end);
+            if (length < minLength) return;
+            const int score = static_cast<int>(length * 4) - static_cast<int>(highbit(offBase));
+            if (score > bestScore) {
+                bestScore = score;
+                bestLength = length;
+                bestOffset = offset;
+            }
+        };
+        for (size_t k = 0; k < 3; ++k) tryOffset(reps[k], k + 1, kMinRepMatch);
+        for (size_t k = 0; k < kCandidateCount; ++k) {
+            const size_t offset = candidates[k];
+            if (offset != reps[0] && offset != reps[1] && offset != reps[2]) tryOffset(offset, offset + 3, kMinMatch);
+        }
+        const uint32_t hash = hash6(ip);
+        const size_t previous = table[hash];
+        table[hash] = static_cast<uint32_t>(position);
+        if (previous < position) tryOffset(position - previous, position - previous + 3, kMinMatch);
+
+        if (bestLength == 0) {
+            ip += 1 + (static_cast<size_t>(ip - anchor) >> kSkipShift);
+            continue;
+        }
+
+        // 向前延伸到字面量中
+        while (ip > anchor && static_cast<size_t>(ip - src) > bestOffset
+               && ip[-1] == ip[-1 - static_cast<ptrdiff_t>(bestOffset)]) {
+            --ip;
+            ++bestLength;
+        }
+        if (nbSeq + 1 >= outSeqsCapacity) return ZSTD_SEQUENCE_PRODUCER_ERROR;
+        ZSTD_Sequence& seq = outSeqs[nbSeq++];
+        seq.offset = static_cast<unsigned>(bestOffset);
+        seq.litLength = static_cast<unsigned>(ip - anchor);
+        seq.matchLength = static_cast<unsigned>(bestLength);
+        seq.rep = 0;
+        ip += bestLength;
+        anchor = ip;
+        matched += bestLength;
+        // 重复偏移按最近使用排序
+        if (bestOffset == reps[1]) {
+            std::swap(reps[0], reps[1]);
+        } else if (bestOffset == reps[2]) {
+            reps[2] = reps[1];
+            reps[1] = reps[0];
+            reps[0] = bestOffset;
+        } else if (bestOffset != reps[0]) {
+            reps[2] = reps[1];
+            reps[1] = reps[0];
+            reps[0] = bestOffset;
+        }
+        // 匹配末尾附近的位置补进哈希表
+        if (ip - 2 < hashLimit) table[hash6(ip - 2)] = static_cast<uint32_t>(ip - 2 - src);
+    }
+
+    if (matched < srcSize / kFallbackRatio) return ZSTD_SEQUENCE_PRODUCER_ERROR;
+
+    // 块末尾的字面量作为块分隔
+    ZSTD_Sequence& last = outSeqs[nbSeq++];
+    last.offset = 0;
+    last.litLength = static_cast<unsigned>(end - anchor);
+    last.matchLength = 0;
+    last.rep = 0;
+    return nbSeq;
+}
+
+} // namespace
+
+void registerRowMatchFinder(ZSTD_CCtx* cctx, RowMatchState* state) {
+    if (state) {
+        ZSTD_registerSequenceProducer(cctx, state, rowMatchProducer);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableSeqProducerFallback, 1);
+        // 快速级别默认不把外部偏移转成重复偏移码，行跨度偏移恰好大量重复，需要显式开启
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_repcodeResolution, ZSTD_ps_enable);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, ZSTD_ps_disable);
+        return;
+    }
+    ZSTD_registerSequenceProducer(cctx, nullptr, nullptr);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableSeqProducerFallback, 0);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_repcodeResolution, ZSTD_ps_auto);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, ZSTD_ps_auto);
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,28 @@
+#ifndef ROWMATCHFINDER_H
+#define ROWMATCHFINDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <zstd.h>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 按行跨度查找匹配的外部序列生成器状态：rowPeriod 为相邻两行在输入中的字节距离，bpp 为每像素字节数；
+    // hashTable / reps 为生成器内部的哈希表和最近使用的偏移，调用方无需设置
+    struct RowMatchState {
+        size_t rowPeriod = 0;
+        size_t bpp = 0;
+        std::vector<uint32_t> hashTable;
+        size_t reps[3] = {};
+    };
+
+    // 在 cctx 上注册行匹配生成器（state 为 nullptr 时取消注册并恢复默认参数）。
+    // 生成器只在当前块内匹配，匹配不足的块退回 zstd 内置匹配器；注册期间不能使用多线程和长距离匹配
+    void registerRowMatchFinder(ZSTD_CCtx* cctx, RowMatchState* state);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // ROWMATCHFINDER_H
@@ -0,0 +1,77 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "rowMatchFinder.h"
+#include <zstd.h>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace zstd_compressor;
+
+namespace {
+
+// 生成带渐变、重复纹理和噪声的随机图像，行跨度包含填充
+std::vector<unsigned char> makeImage(std::mt19937& random, size_t width, size_t height, size_t bpp, size_t stride) {
+    std::vector<unsigned char> pixels(stride * height);
+    const unsigned tile = 1 + random() % 16;
+    const unsigned noise = random() % 32;
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width * bpp; ++x) {
+            unsigned value = static_cast<unsigned>((x / bpp + y) / 3 + (x / bpp / tile + y / tile) % 2 * 64);
+            if (noise != 0) value += random() % noise;
+            pixels[y * stride + x] = static_cast<unsigned char>(value);
+        }
+    }
+    return pixels;
+}
+
+// 开启 ZSTD_c_validateSequences 压缩：生成器输出的序列引用了当前块以外的数据时 zstd 返回错误
+bool roundTrip(const std::vector<unsigned char>& input, size_t rowPeriod, size_t bpp, int level) {
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    detail::RowMatchState state;
+    state.rowPeriod = rowPeriod;
+    state.bpp = bpp;
+    detail::registerRowMatchFinder(cctx, &state);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    ZSTD_CCtx_setParameter(cctx, ZSTD_c_validateSequences, 1);
+
+    std::vector<unsigned char> compressed(ZSTD_compressBound(input.size()));
+    const size_t size = ZSTD_compress2(cctx, compressed.data(), compressed.size(), input.data(), input.size());
+    ZSTD_freeCCtx(cctx);
+    if (ZSTD_isError(size)) {
+        std::printf("compress failed: %s\n", ZSTD_getErrorName(size));
+        return false;
+    }
+
+    std::vector<unsigned char> output(input.size());
+    const size_t restored = ZSTD_decompress(output.data(), output.size(), compressed.data(), size);
+    if (ZSTD_isError(restored) || restored != input.size() || output != input) {
+        std::printf("round trip mismatch\n");
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 random(12345);
+    int failures = 0;
+    for (int i = 0; i < 200; ++i) {
+        const size_t bpp = (i % 4) + 1;
+        const size_t width = 1 + random() % 700;
+        const size_t height = 1 + random() % 400;
+        const size_t stride = width * bpp + random() % 8;
+        const auto image = makeImage(random, width, height, bpp, stride);
+        if (!roundTrip(image, stride, bpp, 1 + i % 5)) {
+            std::printf("image %d (%zux%zu, %zu bytes per pixel) failed\n", i, width, height, bpp);
+            ++failures;
+        }
+    }
+    // 一行跨多个块：上方像素永远不在当前块内，生成器应整块退回内置匹配器
+    std::vector<unsigned char> wide = makeImage(random, 100000, 4, 3, 300000);
+    if (!roundTrip(wide, 300000, 3, 1)) ++failures;
+
+    std::printf(failures ? "FAILED %d\n" : "OK\n", failures);
+    return failures == 0 ? 0 : 1;
+}
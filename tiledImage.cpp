@@ -0,0 +1,105 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "tiledImage.h"
+#include "byteOrder.h"
+#include "rawImage.h"
+#include <zstd.h>
+#include <cstring>
+#include <utility>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+constexpr unsigned char kTileTag[4] = { 'Z', 'B', 'M', 'T' };
+constexpr unsigned char kTileVersion = 1;
+// 索引帧内容：标签(4) | 版本(1) | 格式(1) | 通道数(1) | 位深(1) | LE32 宽 | LE32 高
+//           | LE32 块宽 | LE32 块高 | LE32 块数 | 块表
+constexpr size_t kIndexHeaderSize = 28;
+constexpr size_t kIndexEntrySize = 12;   // LE64 偏移 | LE32 长度
+
+} // namespace
+
+size_t writeTileIndex(const TileIndex& index, std::vector<unsigned char>& out) {
+    std::vector<unsigned char> body(kIndexHeaderSize + index.tiles.size() * kIndexEntrySize, 0);
+    std::memcpy(body.data(), kTileTag, sizeof(kTileTag));
+    body[4] = kTileVersion;
+    body[5] = static_cast<unsigned char>(index.image.format);
+    body[6] = index.image.channels;
+    body[7] = index.image.depth;
+    writeLE32(body.data() + 8, index.image.width);
+    writeLE32(body.data() + 12, index.image.height);
+    writeLE32(body.data() + 16, index.tileWidth);
+    writeLE32(body.data() + 20, index.tileHeight);
+    writeLE32(body.data() + 24, static_cast<uint32_t>(index.tiles.size()));
+
+    unsigned char* entry = body.data() + kIndexHeaderSize;
+    for (const TileFrame& tile : index.tiles) {
+        writeLE64(entry, tile.offset);
+        writeLE32(entry + 8, tile.size);
+        entry += kIndexEntrySize;
+    }
+
+    const size_t offset = out.size();
+    out.resize(offset + kSkippableHeaderSize + body.size());
+    const size_t written = ZSTD_writeSkippableFrame(out.data() + offset, out.size() - offset,
+                                                    body.data(), body.size(), kTileIndexMagicVariant);
+    if (ZSTD_isError(written)) {
+        out.resize(offset);
+        return 0;
+    }
+    return written;
+}
+
+bool isTiledImage(const unsigned char* src, size_t size) {
+    if (size < kSkippableHeaderSize + sizeof(kTileTag)) return false;
+    if (readLE32(src) != ZSTD_MAGIC_SKIPPABLE_START + kTileIndexMagicVariant) return false;
+    return std::memcmp(src + kSkippableHeaderSize, kTileTag, sizeof(kTileTag)) == 0;
+}
+
+size_t tileIndexSize(const unsigned char* header) {
+    if (readLE32(header) != ZSTD_MAGIC_SKIPPABLE_START + kTileIndexMagicVariant) return 0;
+    return kSkippableHeaderSize + readLE32(header + 4);
+}
+
+bool readTileIndex(const unsigned char* src, size_t size, uint64_t totalSize, TileIndex& index, size_t& indexSize) {
+    if (!isTiledImage(src, size) || size < kSkippableHeaderSize + kIndexHeaderSize) return false;
+
+    const unsigned char* body = src + kSkippableHeaderSize;
+    const size_t bodySize = readLE32(src + 4);
+    if (body[4] != kTileVersion || bodySize > size - kSkippableHeaderSize) return false;
+
+    TileIndex parsed;
+    parsed.image.format = static_cast<PixelFormat>(body[5]);
+    parsed.image.channels = body[6];
+    parsed.image.depth = body[7];
+    parsed.image.width = readLE32(body + 8);
+    parsed.image.height = readLE32(body + 12);
+    parsed.image.stride = static_cast<uint32_t>(parsed.image.width * bytesPerPixel(parsed.image));
+    parsed.tileWidth = readLE32(body + 16);
+    parsed.tileHeight = readLE32(body + 20);
+    if (!parsed.image.valid() || parsed.tileWidth == 0 || parsed.tileHeight == 0) return false;
+
+    const size_t count = readLE32(body + 24);
+    if (count != static_cast<size_t>(parsed.columns()) * parsed.rows()
+        || bodySize != kIndexHeaderSize + count * kIndexEntrySize) return false;
+
+    const size_t frameSize = kSkippableHeaderSize + bodySize;
+    if (totalSize < frameSize) return false;
+    const uint64_t dataSize = totalSize - frameSize;
+    parsed.tiles.resize(count);
+    const unsigned char* entry = body + kIndexHeaderSize;
+    for (size_t i = 0; i < count; ++i, entry += kIndexEntrySize) {
+        TileFrame& tile = parsed.tiles[i];
+        tile.offset = readLE64(entry);
+        tile.size = readLE32(entry + 8);
+        if (tile.offset > dataSize || tile.size > dataSize - tile.offset) return false;
+    }
+
+    index = std::move(parsed);
+    indexSize = frameSize;
+    return true;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,46 @@
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+
+#include "zstdBmpCompressor.h"
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 分块索引使用的 zstd 可跳过帧编号（0x184D2A50 + 变体）
+    constexpr unsigned kTileIndexMagicVariant = 0xD;
+
+    // 一个块在数据中的位置：offset 从索引帧末尾算起，内容为独立的 RAW 头部帧 + zstd 帧
+    struct TileFrame {
+        uint64_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    // 分块图像：整幅图按 tileWidth x tileHeight 切块（右侧、底部的块可能更小），块按行优先排列；
+    // 横向条带是 tileWidth 等于图像宽度的特例
+    struct TileIndex {
+        RawImageInfo image; // 整幅图像的描述（stride 为紧凑存储的行字节数，transforms 不使用）
+        uint32_t tileWidth = 0;
+        uint32_t tileHeight = 0;
+        std::vector<TileFrame> tiles;
+
+        uint32_t columns() const { return (image.width + tileWidth - 1) / tileWidth; }
+        uint32_t rows() const { return (image.height + tileHeight - 1) / tileHeight; }
+    };
+
+    // 将索引写成一个可跳过帧追加到 out，返回写入的字节数（失败返回 0）
+    size_t writeTileIndex(const TileIndex& index, std::vector<unsigned char>& out);
+
+    // 判断数据是否以分块索引帧开始
+    bool isTiledImage(const unsigned char* src, size_t size);
+
+    // 数据开头 8 字节（可跳过帧头）记录的索引帧长度，不是分块索引帧时返回 0
+    size_t tileIndexSize(const unsigned char* header);
+
+    // 解析分块索引帧（src 至少包含 size 字节的完整索引帧），totalSize 为索引帧加全部块数据的长度，
+    // 块位置超出 totalSize 时返回 false；indexSize 返回索引帧长度
+    bool readTileIndex(const unsigned char* src, size_t size, uint64_t totalSize, TileIndex& index, size_t& indexSize);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // TILEDIMAGE_H
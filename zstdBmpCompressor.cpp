@@ -1,13 +1,381 @@
 #include "zstdBmpCompressor.h"
+#include "rawImage.h"
+#include "bmpCodec.h"
+#include "imageSequence.h"
+#include "pixelTransform.h"
+#include "rowMatchFinder.h"
+#include "tiledImage.h"
+#include "imagePyramid.h"
+#include "pixelScale.h"
+#include "packArchive.h"
+#include "imageSimilarity.h"
+#include "imageDictionary.h"
+#include "dictionaryMonitor.h"
+#include "zstdThreadPool.h"
 #include <zstd.h>
 #include <fstream>
 #include <filesystem>
 #include <QBuffer>
 #include <QImageReader>
 #include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <thread>
 
 namespace zstd_compressor {
 
+namespace {
+
+// BMP 解析结果对应的 RAW 像素描述（readBmp 输出 GRAY / BGR / BGRA / BGRX）。
+// 与 Qt 一致，没有 Alpha 掩码的 32 位 BMP 按 RGB32 处理，否则保留字节 0 会变成全透明
+RawImageInfo bmpInfo(const detail::BmpImage& bmp) {
+    RawImageInfo info;
+    switch (bmp.channels) {
+        case 1: info.format = PixelFormat::PIXEL_GRAY8; break;
+        case 3: info.format = PixelFormat::PIXEL_BGR888; break;
+        default: info.format = bmp.alpha ? PixelFormat::PIXEL_BGRA8888 : PixelFormat::PIXEL_BGRX8888; break;
+    }
+    info.width = bmp.width;
+    info.height = bmp.height;
+    info.channels = bmp.channels;
+    info.depth = 8;
+    info.stride = static_cast<uint32_t>(info.width * detail::bytesPerPixel(info));
+    return info;
+}
+
+void copyRows(const unsigned char* src, size_t srcStride, unsigned char* dst, size_t dstStride,
+              size_t rowBytes, size_t rows) {
+    for (size_t y = 0; y < rows; ++y) {
+        std::memcpy(dst + y * dstStride, src + y * srcStride, rowBytes);
+    }
+}
+
+// 把已解压的 RAW payload 还原成像素写入 dst 并校验；payload 与 dst 相同表示已直接解压到位
+CompressionResult restoreRawPixels(const RawImageInfo& info, const unsigned char* payload, size_t payloadSize,
+                                   unsigned char* dst, size_t dstStride) {
+    if (info.transforms != TRANSFORM_NONE) {
+        if (!detail::decodeRawPayload(info, payload, payloadSize, dst, dstStride)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to restore raw image");
+        }
+    } else if (payloadSize != info.dataSize()) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Raw image size mismatch");
+    } else if (payload != dst) {
+        detail::unpackRows(payload, info.stride, dst, dstStride, info.height);
+    }
+    if (info.checksum != 0 && detail::pixelChecksum(dst, dstStride, info.stride, info.height) != info.checksum) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Raw image checksum mismatch");
+    }
+    return CompressionResult(CompressResult::SUCCESS);
+}
+
+// 按帧头中的字典 ID 选择 DDict：先看本实例加载的字典，再查全局注册表。
+// 不使用 ZSTD_d_refMultipleDDicts：一次性解压接口在读帧头之前就载入了最后引用的 DDict，
+// 多个字典时其它字典的帧会被错误解码
+size_t decompressFrame(ZSTD_DCtx* dctx, void* dst, size_t dstCapacity, const void* src, size_t srcSize,
+                       const ZSTD_DDict* local) {
+    const unsigned dictID = ZSTD_getDictID_fromFrame(src, srcSize);
+    const ZSTD_DDict* ddict = nullptr;
+    if (dictID != 0) {
+        ddict = local && ZSTD_getDictID_fromDDict(local) == dictID
+            ? local : detail::DictionaryRegistry::instance().find(dictID);
+    }
+    return ZSTD_decompress_usingDDict(dctx, dst, dstCapacity, src, srcSize, ddict);
+}
+
+// 压缩前设置级别、工作线程数（引用共享线程池）和 CDict，返回第一个被拒绝的设置的错误码
+size_t configureContext(ZSTD_CCtx* cctx, int level, int nbWorkers, const ZSTD_CDict* cdict) {
+    const size_t code = detail::configureCompression(cctx, level, nbWorkers);
+    return ZSTD_isError(code) ? code : detail::referenceCDict(cctx, cdict);
+}
+
+// 解压 RAW 头部帧之后的 zstd 帧，像素按 dstStride 直接写到 dst（调用方保证能容纳 info 描述的图像）。
+// 没有预处理且行跨度一致时 zstd 直接解压到 dst，否则经过 work 中转；头部带校验和时校验结果
+CompressionResult decompressRawFrame(ZSTD_DCtx* dctx, const ZSTD_DDict* ddict, const unsigned char* src, size_t srcSize,
+                                     const RawImageInfo& info, std::vector<unsigned char>& work,
+                                     unsigned char* dst, size_t dstStride) {
+    const size_t decompressedSize = ZSTD_getFrameContentSize(src, srcSize);
+    if (decompressedSize == ZSTD_CONTENTSIZE_ERROR) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid compressed data");
+    }
+    if (decompressedSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Unknown content size");
+    }
+    const bool transformed = info.transforms != TRANSFORM_NONE;
+    if (!transformed && decompressedSize != info.dataSize()) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Raw image size mismatch");
+    }
+
+    const bool direct = !transformed && dstStride == info.stride;
+    unsigned char* target = dst;
+    if (!direct) {
+        work.resize(decompressedSize);
+        target = work.data();
+    }
+    const size_t actualSize = decompressFrame(dctx, target, decompressedSize, src, srcSize, ddict);
+    if (ZSTD_isError(actualSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, ZSTD_getErrorName(actualSize));
+    }
+    if (actualSize != decompressedSize) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Decompressed size mismatch");
+    }
+
+    return restoreRawPixels(info, target, actualSize, dst, dstStride);
+}
+
+// 两帧像素布局相同时才能做帧间差分
+bool sameLayout(const RawImageInfo& a, const RawImageInfo& b) {
+    return a.width == b.width && a.height == b.height && a.stride == b.stride
+        && a.channels == b.channels && a.depth == b.depth && a.format == b.format;
+}
+
+// 聚类用的图像签名：BMP 直接解析像素，其它格式交给 OpenCV 解码，仍无法解码时只统计文件字节
+detail::ImageSignature fileSignature(const std::string& filename) {
+    detail::ImageSignature signature;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return signature;
+    const auto size = file.tellg();
+    if (size <= 0) return signature;
+    file.seekg(0, std::ios::beg);
+    std::vector<unsigned char> data(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return signature;
+
+    detail::BmpImage bmp;
+    if (detail::readBmp(data.data(), data.size(), bmp)) {
+        detail::imageSignature(bmp.pixels, bmp.stride, bmp.width, bmp.height, bmp.channels, signature);
+        return signature;
+    }
+    cv::Mat image;
+    try {
+        image = cv::imdecode(data, cv::IMREAD_UNCHANGED);
+    } catch (...) {
+        image = cv::Mat();
+    }
+    if (!image.empty()) {
+        detail::imageSignature(image.data, image.step, image.cols, image.rows, image.elemSize(), signature);
+    } else {
+        detail::dataSignature(data.data(), data.size(), signature);
+    }
+    return signature;
+}
+
+bool readFileRange(std::istream& file, uint64_t offset, size_t size, std::vector<unsigned char>& out) {
+    out.resize(size);
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(size));
+    return file.good();
+}
+
+// 从文件末尾读取序列索引
+bool readSequenceIndex(std::istream& file, detail::SequenceIndex& index) {
+    file.seekg(0, std::ios::end);
+    const auto end = file.tellg();
+    if (end < 4) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(end);
+
+    std::vector<unsigned char> footer;
+    if (!readFileRange(file, fileSize - 4, 4, footer)) return false;
+    const size_t indexSize = detail::sequenceIndexSize(footer.data());
+    if (indexSize > fileSize) return false;
+
+    std::vector<unsigned char> indexData;
+    if (!readFileRange(file, fileSize - indexSize, indexSize, indexData)) return false;
+    return detail::readSequenceIndex(indexData.data(), indexData.size(), fileSize - indexSize, index);
+}
+
+// 从文件开头读取金字塔索引，文件不是金字塔格式时返回 false
+bool readPyramidIndex(std::istream& file, detail::PyramidIndex& index, size_t& indexSize) {
+    file.seekg(0, std::ios::end);
+    const auto end = file.tellg();
+    if (end < 8) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(end);
+
+    std::vector<unsigned char> indexData;
+    if (!readFileRange(file, 0, 8, indexData)) return false;
+    const size_t frameSize = detail::pyramidIndexSize(indexData.data());
+    if (frameSize == 0 || frameSize > fileSize) return false;
+    if (!readFileRange(file, 0, frameSize, indexData)) return false;
+    return detail::readPyramidIndex(indexData.data(), indexData.size(), fileSize, index, indexSize);
+}
+
+// 原图数据在文件中的位置：带金字塔时为最后一层，否则为整个文件
+bool locateFullResolution(std::istream& file, uint64_t& offset, uint64_t& size) {
+    file.seekg(0, std::ios::end);
+    const auto end = file.tellg();
+    if (end < 0) return false;
+    detail::PyramidIndex pyramid;
+    size_t indexSize = 0;
+    if (readPyramidIndex(file, pyramid, indexSize)) {
+        const detail::PyramidLevel* level = pyramid.find(0);
+        offset = indexSize + level->offset;
+        size = level->size;
+    } else {
+        file.clear();
+        offset = 0;
+        size = static_cast<uint64_t>(end);
+    }
+    return true;
+}
+
+// 从文件中读取分块索引（base 为分块容器的起始位置），indexSize 返回索引帧长度（块偏移从其末尾算起）
+bool readTileIndex(std::istream& file, uint64_t base, uint64_t size, detail::TileIndex& index, size_t& indexSize) {
+    if (size < 8) return false;
+    std::vector<unsigned char> indexData;
+    if (!readFileRange(file, base, 8, indexData)) return false;
+    const size_t frameSize = detail::tileIndexSize(indexData.data());
+    if (frameSize == 0 || frameSize > size) return false;
+    if (!readFileRange(file, base, frameSize, indexData)) return false;
+    return detail::readTileIndex(indexData.data(), indexData.size(), size, index, indexSize);
+}
+
+// 数据以金字塔索引开始时，把 src / size 定位到原图（level 0）的数据
+bool skipPyramid(const unsigned char*& src, size_t& size) {
+    if (!detail::isImagePyramid(src, size)) return true;
+    detail::PyramidIndex index;
+    size_t indexSize = 0;
+    if (!detail::readPyramidIndex(src, size, size, index, indexSize)) return false;
+    const detail::PyramidLevel* level = index.find(0);
+    src += indexSize + level->offset;
+    size = static_cast<size_t>(level->size);
+    return true;
+}
+
+// RAW 像素格式对应的 QImage 格式（BGR888 存成 RGB888 后需交换 R/B），没有对应格式时返回 Format_Invalid
+QImage::Format qImageFormat(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::PIXEL_GRAY8: return QImage::Format_Grayscale8;
+        case PixelFormat::PIXEL_BGR888: return QImage::Format_RGB888;
+        case PixelFormat::PIXEL_BGRA8888: return QImage::Format_ARGB32;
+        case PixelFormat::PIXEL_BGRX8888: return QImage::Format_RGB32;
+        case PixelFormat::PIXEL_RGB888: return QImage::Format_RGB888;
+        case PixelFormat::PIXEL_RGBA8888: return QImage::Format_RGBA8888;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        case PixelFormat::PIXEL_GRAY16: return QImage::Format_Grayscale16;
+#endif
+        default: return QImage::Format_Invalid;
+    }
+}
+
+// 解压 RAW 数据（单帧、分块或金字塔）前从头部 / 索引取得原图的像素描述，非 RAW 数据返回 false
+bool peekImageInfo(const unsigned char* src, size_t size, RawImageInfo& info) {
+    if (!skipPyramid(src, size)) return false;
+    if (detail::isTiledImage(src, size)) {
+        detail::TileIndex index;
+        size_t indexSize = 0;
+        if (!detail::readTileIndex(src, size, size, index, indexSize)) return false;
+        info = index.image;
+        return true;
+    }
+    size_t headerSize = 0;
+    return detail::readRawHeader(src, size, info, headerSize);
+}
+
+// 区域与图像求交：越界部分裁掉，交集为空时返回 false
+bool clipRegion(const RawImageInfo& image, int x, int y, int width, int height,
+                uint32_t& x0, uint32_t& y0, uint32_t& x1, uint32_t& y1) {
+    if (width <= 0 || height <= 0) return false;
+    const int64_t left = std::max<int64_t>(x, 0);
+    const int64_t top = std::max<int64_t>(y, 0);
+    const int64_t right = std::min<int64_t>(static_cast<int64_t>(x) + width, image.width);
+    const int64_t bottom = std::min<int64_t>(static_cast<int64_t>(y) + height, image.height);
+    if (left >= right || top >= bottom) return false;
+    x0 = static_cast<uint32_t>(left);
+    y0 = static_cast<uint32_t>(top);
+    x1 = static_cast<uint32_t>(right);
+    y1 = static_cast<uint32_t>(bottom);
+    return true;
+}
+
+// 分块图像中区域 [x0, x1) x [y0, y1) 的像素描述（紧凑存储）
+RawImageInfo regionInfo(const detail::TileIndex& index, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+    RawImageInfo info = index.image;
+    info.width = x1 - x0;
+    info.height = y1 - y0;
+    info.stride = static_cast<uint32_t>(info.width * detail::bytesPerPixel(info));
+    info.transforms = TRANSFORM_NONE;
+    return info;
+}
+
+// 并行解码区域 [x0, x1) x [y0, y1) 相交的块，tiles[i] 指向第 i 块的数据（不相交的块为 nullptr），
+// 结果按 dstStride 写入 dst。每个线程使用自己的解压上下文，各块写入输出中互不重叠的位置
+CompressionResult decodeTileRegion(const detail::TileIndex& index, const std::vector<const unsigned char*>& tiles,
+                                   const ZSTD_DDict* ddict,
+                                   uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1, int numThreads,
+                                   unsigned char* dst, size_t dstStride) {
+    const RawImageInfo info = regionInfo(index, x0, y0, x1, y1);
+
+    std::vector<size_t> needed;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        if (tiles[i]) needed.push_back(i);
+    }
+
+    const size_t bpp = detail::bytesPerPixel(info);
+    const uint32_t columns = index.columns();
+    std::vector<CompressionResult> results(needed.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        ZSTD_DCtx* dctx = ZSTD_createDCtx();
+        std::vector<unsigned char> work;
+        std::vector<unsigned char> tilePixels;
+        for (size_t n = next++; n < needed.size(); n = next++) {
+            if (!dctx) {
+                results[n] = CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED,
+                                               "Failed to create decompression context");
+                continue;
+            }
+            const size_t tile = needed[n];
+            const uint32_t tx = static_cast<uint32_t>(tile % columns) * index.tileWidth;
+            const uint32_t ty = static_cast<uint32_t>(tile / columns) * index.tileHeight;
+            RawImageInfo expected = index.image;
+            expected.width = std::min(index.tileWidth, index.image.width - tx);
+            expected.height = std::min(index.tileHeight, index.image.height - ty);
+            expected.stride = static_cast<uint32_t>(expected.width * bpp);
+
+            RawImageInfo tileInfo;
+            size_t headerSize = 0;
+            const unsigned char* src = tiles[tile];
+            const size_t srcSize = index.tiles[tile].size;
+            if (!detail::readRawHeader(src, srcSize, tileInfo, headerSize) || !sameLayout(tileInfo, expected)) {
+                results[n] = CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid tile header");
+                continue;
+            }
+
+            // 完全落在区域内的块（整图解码时的所有条带）直接解压到最终位置，其余块解压后只拷贝交集
+            const uint32_t left = std::max(x0, tx);
+            const uint32_t right = std::min(x1, tx + tileInfo.width);
+            const uint32_t top = std::max(y0, ty);
+            const uint32_t bottom = std::min(y1, ty + tileInfo.height);
+            unsigned char* out = dst + (top - y0) * dstStride + (left - x0) * bpp;
+            if (left == tx && top == ty && right - left == tileInfo.width && bottom - top == tileInfo.height) {
+                results[n] = decompressRawFrame(dctx, ddict, src + headerSize, srcSize - headerSize, tileInfo, work,
+                                                out, dstStride);
+                continue;
+            }
+            tilePixels.resize(tileInfo.dataSize());
+            results[n] = decompressRawFrame(dctx, ddict, src + headerSize, srcSize - headerSize, tileInfo, work,
+                                            tilePixels.data(), tileInfo.stride);
+            if (!results[n].success()) continue;
+            copyRows(tilePixels.data() + (top - ty) * tileInfo.stride + (left - tx) * bpp, tileInfo.stride,
+                     out, dstStride, (right - left) * bpp, bottom - top);
+        }
+        if (dctx) ZSTD_freeDCtx(dctx);
+    };
+
+    const size_t workers = std::clamp<size_t>(static_cast<size_t>(numThreads), 1, std::max<size_t>(1, needed.size()));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    for (const auto& result : results) {
+        if (!result.success()) return result;
+    }
+    return CompressionResult(CompressResult::SUCCESS);
+}
+
+} // namespace
+
 // ZstdContext 析构函数
 ImageCompressor::ZstdContext::~ZstdContext() {
     if (cctx) ZSTD_freeCCtx(cctx);
@@ -18,6 +386,25 @@ ImageCompressor::ImageCompressor(int level)
     : m_level(std::clamp(level, 1, 22))
     , m_num_threads(4)
     , m_format(ImageFormat::FORMAT_BMP)
+    , m_colorTransform(ColorTransform::COLOR_NONE)
+    , m_filterMode(FilterMode::FILTER_NONE)
+    , m_planarLayout(false)
+    , m_planarGainEstimate(false)
+    , m_shuffleMode(ShuffleMode::SHUFFLE_BYTE)
+    , m_paletteMode(false)
+    , m_channelReduction(false)
+    , m_constantTiles(false)
+    , m_keyframeInterval(30)
+    , m_rowMatchFinder(false)
+    , m_tileSize(0)
+    , m_bandRows(0)
+    , m_pyramidLevels(0)
+    , m_solidBlockSize(0)
+    , m_longDistanceMatching(false)
+    , m_similarityGrouping(false)
+    , m_dictData(nullptr)
+    , m_dictSize(0)
+    , m_dictChecksum(0)
     , m_ctx(std::make_unique<ZstdContext>()) {
 }
 
@@ -31,8 +418,72 @@ void ImageCompressor::setImageFormat(ImageFormat format) {
     m_format = format;
 }
 
+void ImageCompressor::setColorTransform(ColorTransform transform) {
+    m_colorTransform = transform;
+}
+
 void ImageCompressor::setNumThreads(int num_threads) {
-    m_num_threads = (num_threads > 0) ? num_threads : 1;
+    m_num_threads = std::max(num_threads, 0);
+}
+
+void ImageCompressor::setFilterMode(FilterMode mode) {
+    m_filterMode = mode;
+}
+
+void ImageCompressor::setPlanarLayout(bool enabled) {
+    m_planarLayout = enabled;
+}
+
+void ImageCompressor::setPlanarGainEstimate(bool enabled) {
+    m_planarGainEstimate = enabled;
+}
+
+void ImageCompressor::setShuffleMode(ShuffleMode mode) {
+    m_shuffleMode = mode;
+}
+
+void ImageCompressor::setPaletteMode(bool enabled) {
+    m_paletteMode = enabled;
+}
+
+void ImageCompressor::setChannelReduction(bool enabled) {
+    m_channelReduction = enabled;
+}
+
+void ImageCompressor::setConstantTileSkipping(bool enabled) {
+    m_constantTiles = enabled;
+}
+
+void ImageCompressor::setKeyframeInterval(int interval) {
+    m_keyframeInterval = std::max(1, interval);
+}
+
+void ImageCompressor::setRowMatchFinder(bool enabled) {
+    m_rowMatchFinder = enabled;
+}
+
+void ImageCompressor::setTileSize(int tileSize) {
+    m_tileSize = std::max(0, tileSize);
+}
+
+void ImageCompressor::setBandRows(int rows) {
+    m_bandRows = std::max(0, rows);
+}
+
+void ImageCompressor::setPyramidLevels(int levels) {
+    m_pyramidLevels = std::max(0, levels);
+}
+
+void ImageCompressor::setSolidBlockSize(int blockSize) {
+    m_solidBlockSize = std::max(0, blockSize);
+}
+
+void ImageCompressor::setLongDistanceMatching(bool enabled) {
+    m_longDistanceMatching = enabled;
+}
+
+void ImageCompressor::setSimilarityGrouping(bool enabled) {
+    m_similarityGrouping = enabled;
 }
 
 bool ImageCompressor::loadImage(const std::string& filename) {
@@ -59,10 +510,12 @@ bool ImageCompressor::loadImage(const cv::Mat& image) {
 bool ImageCompressor::loadImage(std::vector<unsigned char> data) {
     clearResults();
     m_originalData = std::move(data);
+    resetRawSource();
     return !m_originalData.empty();
 }
 
 bool ImageCompressor::loadImageFile(const std::string& filename) {
+    resetRawSource();
     std::ifstream file(filename, std::ios::binary | std::ios::ate);
     if (!file.is_open()) return false;
 
@@ -70,26 +523,51 @@ bool ImageCompressor::loadImageFile(const std::string& filename) {
     if (size <= 0) return false;
 
     file.seekg(0, std::ios::beg);
-    m_originalData.resize(static_cast<size_t>(size));
+    std::vector<unsigned char> data(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) return false;
 
-    if (!file.read(reinterpret_cast<char*>(m_originalData.data()), size)) {
-        m_originalData.clear();
-        return false;
+    if (m_format == ImageFormat::FORMAT_RAW) {
+        // BMP 直接解析为像素视图，其它格式交给 OpenCV 解码
+        if (loadRawBmp(std::move(data))) return true;
+        try {
+            m_cvMat = cv::imread(filename, cv::IMREAD_UNCHANGED);
+        } catch (...) {
+            return false;
+        }
+        return convertToRawData(m_cvMat);
     }
 
-    // 可选：验证图像数据有效性
-    try {
-        m_qImage.load(QString::fromStdString(filename));
-        m_cvMat = cv::imread(filename);
-    } catch (...) {
-        // 忽略图像解码错误，原始数据仍然有效
-    }
+    // 压缩只需要文件字节，QImage / cv::Mat 在 getQImage() / getCVMat() 中按需构建
+    m_originalData = std::move(data);
+    return true;
+}
+
+bool ImageCompressor::loadRawBmp(std::vector<unsigned char> data) {
+    detail::BmpImage bmp;
+    if (!detail::readBmp(data.data(), data.size(), bmp)) return false;
 
+    // 视图引用文件数据；需要展开/翻转时改为持有展开后的像素
+    const size_t offset = bmp.storage.empty() ? static_cast<size_t>(bmp.pixels - data.data()) : 0;
+    m_rawFileData = bmp.storage.empty() ? std::move(data) : std::move(bmp.storage);
+    m_rawSource = cv::Mat(static_cast<int>(bmp.height), static_cast<int>(bmp.width),
+                          CV_MAKETYPE(CV_8U, bmp.channels), m_rawFileData.data() + offset, bmp.stride);
+    m_originalInfo = bmpInfo(bmp);
     return true;
 }
 
 bool ImageCompressor::convertToImageData(const QImage& image) {
     if (image.isNull()) return false;
+    if (m_format == ImageFormat::FORMAT_RAW) return convertToRawData(image);
+    resetRawSource();
+
+    // 内存布局与 BMP 一致的格式直接写出，不经过 Qt 编码器
+    if (m_format == ImageFormat::FORMAT_BMP
+        && (image.format() == QImage::Format_Grayscale8 || image.format() == QImage::Format_ARGB32)) {
+        const uint8_t channels = image.format() == QImage::Format_Grayscale8 ? 1 : 4;
+        return detail::writeBmp(image.constBits(), static_cast<size_t>(image.bytesPerLine()),
+                                static_cast<uint32_t>(image.width()), static_cast<uint32_t>(image.height()),
+                                channels, channels == 4, m_originalData);
+    }
 
     QByteArray byteArray;
     QBuffer buffer(&byteArray);
@@ -112,6 +590,16 @@ bool ImageCompressor::convertToImageData(const QImage& image) {
 
 bool ImageCompressor::convertToImageData(const cv::Mat& image) {
     if (image.empty()) return false;
+    if (m_format == ImageFormat::FORMAT_RAW) return convertToRawData(image);
+    resetRawSource();
+
+    const int channels = image.channels();
+    if (m_format == ImageFormat::FORMAT_BMP && image.depth() == CV_8U
+        && (channels == 1 || channels == 3 || channels == 4)) {
+        return detail::writeBmp(image.data, image.step, static_cast<uint32_t>(image.cols),
+                                static_cast<uint32_t>(image.rows), static_cast<uint8_t>(channels), channels == 4,
+                                m_originalData);
+    }
 
     std::vector<unsigned char> buffer;
     const char* extension = ".bmp";
@@ -129,8 +617,107 @@ bool ImageCompressor::convertToImageData(const cv::Mat& image) {
     return true;
 }
 
+bool ImageCompressor::convertToRawData(const QImage& image) {
+    if (image.isNull()) return false;
+
+    QImage source = image;
+    RawImageInfo info;
+    switch (image.format()) {
+        case QImage::Format_Grayscale8: info.format = PixelFormat::PIXEL_GRAY8; info.channels = 1; break;
+        case QImage::Format_RGB888: info.format = PixelFormat::PIXEL_RGB888; info.channels = 3; break;
+        case QImage::Format_RGB32: info.format = PixelFormat::PIXEL_BGRX8888; info.channels = 4; break;
+        case QImage::Format_ARGB32: info.format = PixelFormat::PIXEL_BGRA8888; info.channels = 4; break;
+        case QImage::Format_RGBA8888: info.format = PixelFormat::PIXEL_RGBA8888; info.channels = 4; break;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 13, 0)
+        case QImage::Format_Grayscale16: info.format = PixelFormat::PIXEL_GRAY16; info.channels = 1; break;
+#endif
+        default:
+            // 其它格式统一转换为 32 位
+            if (image.hasAlphaChannel()) {
+                source = image.convertToFormat(QImage::Format_ARGB32);
+                info.format = PixelFormat::PIXEL_BGRA8888;
+            } else {
+                source = image.convertToFormat(QImage::Format_RGB32);
+                info.format = PixelFormat::PIXEL_BGRX8888;
+            }
+            info.channels = 4;
+            break;
+    }
+    if (source.isNull()) return false;
+
+    info.width = static_cast<uint32_t>(source.width());
+    info.height = static_cast<uint32_t>(source.height());
+    info.depth = (info.format == PixelFormat::PIXEL_GRAY16) ? 16 : 8;
+    info.stride = static_cast<uint32_t>(info.width * detail::bytesPerPixel(info));
+
+    // 直接引用 QImage 的像素内存（constBits 不会触发深拷贝）
+    resetRawSource();
+    m_rawSourceImage = source;
+    m_rawSource = cv::Mat(source.height(), source.width(),
+                          CV_MAKETYPE(info.depth == 16 ? CV_16U : CV_8U, info.channels),
+                          const_cast<unsigned char*>(m_rawSourceImage.constBits()),
+                          static_cast<size_t>(m_rawSourceImage.bytesPerLine()));
+    m_originalInfo = info;
+    return true;
+}
+
+bool ImageCompressor::convertToRawData(const cv::Mat& image) {
+    if (image.empty() || (image.depth() != CV_8U && image.depth() != CV_16U)) return false;
+
+    // 16 位数据按原始位深保存，不再经过 8 位 BMP 编码
+    const bool wide = image.depth() == CV_16U;
+    RawImageInfo info;
+    switch (image.channels()) {
+        case 1: info.format = wide ? PixelFormat::PIXEL_GRAY16 : PixelFormat::PIXEL_GRAY8; break;
+        case 3: info.format = wide ? PixelFormat::PIXEL_BGR161616 : PixelFormat::PIXEL_BGR888; break;
+        case 4: info.format = wide ? PixelFormat::PIXEL_BGRA16161616 : PixelFormat::PIXEL_BGRA8888; break;
+        default: return false;
+    }
+    info.width = static_cast<uint32_t>(image.cols);
+    info.height = static_cast<uint32_t>(image.rows);
+    info.channels = static_cast<uint8_t>(image.channels());
+    info.depth = wide ? 16 : 8;
+    info.stride = static_cast<uint32_t>(info.width * detail::bytesPerPixel(info));
+
+    // 引用计数共享 cv::Mat 数据，压缩时直接从中读取
+    resetRawSource();
+    m_rawSource = image;
+    m_originalInfo = info;
+    return true;
+}
+
+QImage ImageCompressor::rawToQImage(const RawImageInfo& info, const unsigned char* pixels, size_t stride) {
+    const QImage::Format format = qImageFormat(info.format);
+    if (format == QImage::Format_Invalid) return QImage(); // 16 位彩色没有对应的 QImage 格式，请使用 getCVMat()
+
+    QImage image(static_cast<int>(info.width), static_cast<int>(info.height), format);
+    if (image.isNull()) return QImage();
+
+    copyRows(pixels, stride, image.bits(), static_cast<size_t>(image.bytesPerLine()), info.stride, info.height);
+
+    if (info.format == PixelFormat::PIXEL_BGR888) {
+        return image.rgbSwapped();
+    }
+    return image;
+}
+
+cv::Mat ImageCompressor::rawToCVMat(const RawImageInfo& info, const unsigned char* pixels, size_t stride) {
+    cv::Mat mat(static_cast<int>(info.height), static_cast<int>(info.width),
+                CV_MAKETYPE(info.depth == 16 ? CV_16U : CV_8U, info.channels));
+
+    copyRows(pixels, stride, mat.data, mat.step, info.stride, info.height);
+
+    // OpenCV 约定 BGR 顺序
+    if (info.format == PixelFormat::PIXEL_RGB888) {
+        cv::cvtColor(mat, mat, cv::COLOR_RGB2BGR);
+    } else if (info.format == PixelFormat::PIXEL_RGBA8888) {
+        cv::cvtColor(mat, mat, cv::COLOR_RGBA2BGRA);
+    }
+    return mat;
+}
+
 CompressionResult ImageCompressor::compress() {
-    if (m_originalData.empty()) {
+    if (m_originalData.empty() && !m_originalInfo.valid()) {
         return CompressionResult(CompressResult::ERROR_EMPTY_DATA, "No image data loaded");
     }
     return compressInternal();
@@ -157,37 +744,316 @@ CompressionResult ImageCompressor::compressData(const std::vector<unsigned char>
     return compress();
 }
 
-CompressionResult ImageCompressor::compressInternal() {
+CompressionResult ImageCompressor::compressInternal(bool deltaFrame) {
+    auto& monitor = detail::DictionaryMonitor::instance();
+    // 差分帧不是图像：既不统计字典压缩率、不抽作训练样本，也不生成金字塔
+    const bool monitored = m_dictData && monitor.enabled() && !deltaFrame;
+    if (monitored) {
+        // 字典重新训练后发布的后继在注册表中，压缩前切换到最新的
+        const unsigned dictID = getDictionaryID();
+        const unsigned latest = monitor.latest(dictID);
+        if (latest != dictID) useRegisteredDictionary(latest);
+    }
+
     auto& ctx = getContext();
     if (!ctx.cctx) {
         return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to create compression context");
     }
 
-    const size_t maxSize = ZSTD_compressBound(m_originalData.size());
-    m_compressedData.resize(maxSize);
+    m_compressedData.clear();
+    CompressionResult result;
+    RawImageInfo info = m_originalInfo;
+    if (info.valid()) {
+        // RAW 模式：像素描述写在 zstd 帧之前的可跳过帧中，像素直接从源图像读取并经过可逆预处理
+        if (m_tileSize > 0 || m_bandRows > 0) {
+            result = compressTiled();
+        } else {
+            result = compressRawFrame(ctx.cctx, info, m_rawSource.data, m_rawSource.step, m_num_threads,
+                                      m_workBuffer, m_compressedData);
+        }
+        if (result.success() && m_pyramidLevels > 0 && !deltaFrame) {
+            result = compressPyramid();
+        }
+        if (!result.success()) {
+            m_compressedData.clear();
+            return result;
+        }
+        result.original_size = info.dataSize();
+    } else {
+        const size_t maxSize = ZSTD_compressBound(m_originalData.size());
+        m_compressedData.resize(maxSize);
+
+        // 设置被拒绝（例如工作线程数）时直接返回 zstd 的错误，而不是悄悄按单线程压缩
+        const size_t configured = configureContext(ctx.cctx, m_level, m_num_threads, ctx.cdict.get());
+        const size_t compressedSize = ZSTD_isError(configured) ? configured : ZSTD_compress2(ctx.cctx,
+            m_compressedData.data(), maxSize,
+            m_originalData.data(), m_originalData.size());
+
+        if (ZSTD_isError(compressedSize)) {
+            m_compressedData.clear();
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED,
+                                   ZSTD_getErrorName(compressedSize));
+        }
+        m_compressedData.resize(compressedSize);
+        result.original_size = m_originalData.size();
+    }
+
+    result.compressed_size = m_compressedData.size();
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    result.result_code = CompressResult::SUCCESS;
+    if (m_planarGainEstimate && info.valid()) {
+        // 分块输出的各块使用同一组变换（调色板块除外），按整图的变换估计
+        if (m_tileSize > 0 || m_bandRows > 0) info.transforms = rawTransforms(info);
+        if (info.transforms & TRANSFORM_PLANAR) result.planar_gain = estimatePlanarGain(info);
+    }
+
+    // 只统计单帧压缩：分块和金字塔的压缩率不能与单帧比较，送入 zstd 的数据也不是一段
+    if (monitored && m_dictData && m_tileSize <= 0 && m_bandRows <= 0 && m_pyramidLevels <= 0) {
+        const unsigned char* sample = m_originalData.data();
+        size_t sampleSize = m_originalData.size();
+        if (info.valid()) {
+            const bool direct = info.transforms == TRANSFORM_NONE && m_rawSource.step == info.stride;
+            sample = direct ? m_rawSource.data : m_workBuffer.data();
+            sampleSize = direct ? info.dataSize() : m_workBuffer.size();
+        }
+        monitor.record(m_dictData, m_dictSize, m_level, result.original_size, result.compressed_size,
+                       sample, std::min(sampleSize, detail::kMaxDictionarySampleBytes));
+    }
+
+    return result;
+}
+
+bool ImageCompressor::prepareRawPayload(RawImageInfo& info, const unsigned char* pixels, size_t stride,
+                                        std::vector<unsigned char>& payload,
+                                        const unsigned char*& input, size_t& inputSize) const {
+    // 调色板优先：颜色数超过 256 时统计会提前退出，再按常规预处理编码
+    info.transforms = TRANSFORM_PALETTE;
+    if (!m_paletteMode || !detail::supportsPalette(info)
+        || !detail::encodeRawPayload(info, pixels, stride, payload)) {
+        info.transforms = rawTransforms(info);
+    }
+
+    input = payload.data();
+    inputSize = payload.size();
+    if (info.transforms == TRANSFORM_NONE && stride == info.stride) {
+        input = pixels;
+        inputSize = info.dataSize();
+    } else if (info.transforms != TRANSFORM_PALETTE) {
+        if (!detail::encodeRawPayload(info, pixels, stride, payload)) {
+            return false;
+        }
+        input = payload.data();
+        inputSize = payload.size();
+    }
+
+    info.checksum = detail::pixelChecksum(pixels, stride, info.stride, info.height);
+    return true;
+}
+
+CompressionResult ImageCompressor::compressRawFrame(ZSTD_CCtx* cctx, RawImageInfo& info, const unsigned char* pixels,
+                                                    size_t stride, int numThreads, std::vector<unsigned char>& payload,
+                                                    std::vector<unsigned char>& out) const {
+    const unsigned char* input = nullptr;
+    size_t inputSize = 0;
+    if (!prepareRawPayload(info, pixels, stride, payload, input, inputSize)) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to transform raw image");
+    }
+
+    const size_t offset = out.size();
+    const size_t headerSize = detail::writeRawHeader(info, out);
+    if (headerSize == 0) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write raw image header");
+    }
+
+    const size_t maxSize = ZSTD_compressBound(inputSize);
+    out.resize(offset + headerSize + maxSize);
 
-    ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_compressionLevel, m_level);
-    ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_nbWorkers, m_num_threads);
+    // 行匹配生成器需要知道 payload 的行跨度；外部序列生成器不支持 zstd 多线程
+    detail::RowMatchState rowMatch;
+    // 外部序列生成器看不到字典，加载字典时不使用
+    const bool rowMatching = m_rowMatchFinder && !m_ctx->cdict
+        && detail::rawPayloadGeometry(info, input, inputSize, rowMatch.rowPeriod, rowMatch.bpp);
+    if (rowMatching) {
+        detail::registerRowMatchFinder(cctx, &rowMatch);
+    }
 
-    const size_t compressedSize = ZSTD_compress2(ctx.cctx,
-        m_compressedData.data(), maxSize,
-        m_originalData.data(), m_originalData.size());
+    const size_t configured = configureContext(cctx, m_level, rowMatching ? 0 : numThreads, m_ctx->cdict.get());
+    const size_t compressedSize = ZSTD_isError(configured) ? configured : ZSTD_compress2(cctx,
+        out.data() + offset + headerSize, maxSize,
+        input, inputSize);
+    if (rowMatching) detail::registerRowMatchFinder(cctx, nullptr);
 
     if (ZSTD_isError(compressedSize)) {
-        m_compressedData.clear();
-        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED,
-                               ZSTD_getErrorName(compressedSize));
+        out.resize(offset);
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, ZSTD_getErrorName(compressedSize));
+    }
+    out.resize(offset + headerSize + compressedSize);
+    return CompressionResult(CompressResult::SUCCESS);
+}
+
+CompressionResult ImageCompressor::compressTiled() {
+    // 每块独立选择预处理并压缩成 RAW 头部帧 + zstd 帧，块之间并行，每个线程使用自己的压缩上下文。
+    // 条带模式就是整行宽度的块，解压时每个条带直接写入输出中的最终行
+    const RawImageInfo& info = m_originalInfo;
+    const size_t bpp = detail::bytesPerPixel(info);
+    detail::TileIndex index;
+    index.image = info;
+    index.image.transforms = TRANSFORM_NONE;
+    index.tileWidth = m_tileSize > 0 ? static_cast<uint32_t>(m_tileSize) : info.width;
+    index.tileHeight = static_cast<uint32_t>(m_tileSize > 0 ? m_tileSize : m_bandRows);
+    const uint32_t columns = index.columns();
+    const size_t count = static_cast<size_t>(columns) * index.rows();
+
+    std::vector<std::vector<unsigned char>> frames(count);
+    std::vector<CompressionResult> results(count);
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        ZSTD_CCtx* cctx = ZSTD_createCCtx();
+        std::vector<unsigned char> payload;
+        for (size_t tile = next++; tile < count; tile = next++) {
+            if (!cctx) {
+                results[tile] = CompressionResult(CompressResult::ERROR_COMPRESS_FAILED,
+                                                  "Failed to create compression context");
+                continue;
+            }
+            const uint32_t tx = static_cast<uint32_t>(tile % columns) * index.tileWidth;
+            const uint32_t ty = static_cast<uint32_t>(tile / columns) * index.tileHeight;
+            RawImageInfo tileInfo = info;
+            tileInfo.width = std::min(index.tileWidth, info.width - tx);
+            tileInfo.height = std::min(index.tileHeight, info.height - ty);
+            tileInfo.stride = static_cast<uint32_t>(tileInfo.width * bpp);
+            const unsigned char* pixels = m_rawSource.data + ty * m_rawSource.step + tx * bpp;
+            results[tile] = compressRawFrame(cctx, tileInfo, pixels, m_rawSource.step, 0, payload, frames[tile]);
+        }
+        if (cctx) ZSTD_freeCCtx(cctx);
+    };
+
+    const size_t workers = std::clamp<size_t>(static_cast<size_t>(m_num_threads), 1, count);
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    uint64_t offset = 0;
+    index.tiles.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!results[i].success()) return results[i];
+        // 块表中块长度为 LE32：大 bandRows 的条带在超大图像上可能超过 4 GiB，此时不能写出容器
+        if (frames[i].size() > UINT32_MAX) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Tile frame exceeds 4 GiB");
+        }
+        index.tiles[i].offset = offset;
+        index.tiles[i].size = static_cast<uint32_t>(frames[i].size());
+        offset += frames[i].size();
     }
 
-    m_compressedData.resize(compressedSize);
+    m_compressedData.clear();
+    if (detail::writeTileIndex(index, m_compressedData) == 0) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write tile index");
+    }
+    m_compressedData.reserve(m_compressedData.size() + offset);
+    for (const auto& frame : frames) {
+        m_compressedData.insert(m_compressedData.end(), frame.begin(), frame.end());
+    }
 
-    CompressionResult result;
-    result.original_size = m_originalData.size();
-    result.compressed_size = compressedSize;
-    result.compression_ratio = static_cast<double>(compressedSize) / result.original_size;
-    result.result_code = CompressResult::SUCCESS;
+    return CompressionResult(CompressResult::SUCCESS);
+}
 
-    return result;
+CompressionResult ImageCompressor::compressPyramid() {
+    // 第 1 层直接从源像素缩小，之后每层从上一层缩小，两个缓冲区轮换；层数用完或长边不超过
+    // kMinPyramidSize 时停止。m_compressedData 中已有的原图数据作为最后一层
+    constexpr uint32_t kMinPyramidSize = 64;
+    auto& ctx = getContext();
+    const size_t sampleBytes = (m_originalInfo.depth + 7) / 8;
+    const unsigned char* src = m_rawSource.data;
+    size_t srcStride = m_rawSource.step;
+    RawImageInfo level = m_originalInfo;
+    std::vector<unsigned char> current;
+    std::vector<unsigned char> previous;
+    std::vector<std::vector<unsigned char>> frames;
+    detail::PyramidIndex index;
+
+    for (int k = 1; k <= m_pyramidLevels && std::max(level.width, level.height) > kMinPyramidSize; ++k) {
+        RawImageInfo next = level;
+        next.width = static_cast<uint32_t>(detail::halfSize(level.width));
+        next.height = static_cast<uint32_t>(detail::halfSize(level.height));
+        next.stride = static_cast<uint32_t>(next.width * detail::bytesPerPixel(next));
+        current.resize(next.dataSize());
+        detail::downsampleHalf(src, srcStride, level.width, level.height, level.channels, sampleBytes,
+                               current.data(), next.stride);
+
+        frames.emplace_back();
+        RawImageInfo frameInfo = next;
+        const auto result = compressRawFrame(ctx.cctx, frameInfo, current.data(), next.stride, m_num_threads,
+                                             m_workBuffer, frames.back());
+        if (!result.success()) return result;
+
+        detail::PyramidLevel entry;
+        entry.level = static_cast<uint32_t>(k);
+        entry.width = next.width;
+        entry.height = next.height;
+        entry.size = frames.back().size();
+        index.levels.insert(index.levels.begin(), entry);
+
+        previous.swap(current);
+        src = previous.data();
+        srcStride = next.stride;
+        level = next;
+    }
+
+    detail::PyramidLevel full;
+    full.width = m_originalInfo.width;
+    full.height = m_originalInfo.height;
+    full.size = m_compressedData.size();
+    index.levels.push_back(full);
+    uint64_t offset = 0;
+    for (auto& entry : index.levels) {
+        entry.offset = offset;
+        offset += entry.size;
+    }
+
+    std::vector<unsigned char> out;
+    if (detail::writePyramidIndex(index, out) == 0) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write pyramid index");
+    }
+    out.reserve(out.size() + offset);
+    for (auto frame = frames.rbegin(); frame != frames.rend(); ++frame) {
+        out.insert(out.end(), frame->begin(), frame->end());
+    }
+    out.insert(out.end(), m_compressedData.begin(), m_compressedData.end());
+    m_compressedData.swap(out);
+    return CompressionResult(CompressResult::SUCCESS);
+}
+
+double ImageCompressor::estimatePlanarGain(const RawImageInfo& info) {
+    // 取中间一段行（约 1/16，至多 256KB），分别在开启/关闭平面化时压缩，比较输出大小
+    constexpr size_t kMaxSampleBytes = 256 * 1024;
+    const size_t maxRows = std::max<size_t>(1, kMaxSampleBytes / info.stride);
+    const size_t sampleRows = std::clamp<size_t>(info.height / 16, 1, maxRows);
+    const size_t firstRow = (info.height - sampleRows) / 2;
+    const unsigned char* sample = m_rawSource.data + firstRow * m_rawSource.step;
+
+    RawImageInfo sampleInfo = info;
+    sampleInfo.height = static_cast<uint32_t>(sampleRows);
+
+    // 独立的上下文，只按压缩级别压缩：不受上一帧留下的字典、工作线程和金字塔层参数影响
+    ZSTD_CCtx* cctx = ZSTD_createCCtx();
+    if (!cctx) return 0.0;
+    auto compressedSampleSize = [&](uint32_t transforms) -> size_t {
+        sampleInfo.transforms = transforms;
+        std::vector<unsigned char> payload;
+        if (!detail::encodeRawPayload(sampleInfo, sample, m_rawSource.step, payload)) return 0;
+        std::vector<unsigned char> compressed(ZSTD_compressBound(payload.size()));
+        const size_t size = ZSTD_compressCCtx(cctx, compressed.data(), compressed.size(),
+                                              payload.data(), payload.size(), m_level);
+        return ZSTD_isError(size) ? 0 : size;
+    };
+
+    const size_t withPlanar = compressedSampleSize(info.transforms);
+    const size_t withoutPlanar = compressedSampleSize(info.transforms & ~static_cast<uint32_t>(TRANSFORM_PLANAR));
+    ZSTD_freeCCtx(cctx);
+    if (withPlanar == 0 || withoutPlanar == 0) return 0.0;
+    return static_cast<double>(withoutPlanar) / withPlanar;
 }
 
 CompressionResult ImageCompressor::decompress(const std::vector<unsigned char>& compressedData) {
@@ -233,53 +1099,357 @@ CompressionResult ImageCompressor::decompressInternal() {
         return CompressionResult(CompressResult::ERROR_EMPTY_DATA, "No compressed data");
     }
 
-    const size_t decompressedSize = ZSTD_getFrameContentSize(m_compressedData.data(), m_compressedData.size());
-    if (decompressedSize == ZSTD_CONTENTSIZE_ERROR) {
-        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid compressed data");
-    }
-    if (decompressedSize == ZSTD_CONTENTSIZE_UNKNOWN) {
-        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Unknown content size");
+    return decodeImageData(m_compressedData.data(), m_compressedData.size());
+}
+
+CompressionResult ImageCompressor::decodeImageData(const unsigned char* src, size_t srcSize) {
+    auto& ctx = getContext();
+    const size_t compressedSize = srcSize;
+    if (!skipPyramid(src, srcSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid pyramid index");
     }
 
-    m_decompressedData.resize(decompressedSize);
-    const size_t actualSize = ZSTD_decompressDCtx(ctx.dctx,
-        m_decompressedData.data(), decompressedSize,
-        m_compressedData.data(), m_compressedData.size());
+    CompressionResult result;
+    if (detail::isTiledImage(src, srcSize) || detail::isRawImageFrame(src, srcSize)) {
+        if (!peekImageInfo(src, srcSize, m_rawInfo)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid raw image header");
+        }
+        m_decompressedData.resize(m_rawInfo.dataSize());
+        result = decodeRawImage(src, srcSize, m_decompressedData.data(), m_rawInfo.stride);
+        if (!result.success()) {
+            m_decompressedData.clear();
+            m_rawInfo = RawImageInfo();
+            return result;
+        }
+    } else {
+        const size_t decompressedSize = ZSTD_getFrameContentSize(src, srcSize);
+        if (decompressedSize == ZSTD_CONTENTSIZE_ERROR) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid compressed data");
+        }
+        if (decompressedSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Unknown content size");
+        }
+
+        m_decompressedData.resize(decompressedSize);
+        const size_t actualSize = decompressFrame(ctx.dctx,
+            m_decompressedData.data(), decompressedSize,
+            src, srcSize, ctx.ddict.get());
 
-    if (ZSTD_isError(actualSize)) {
-        m_decompressedData.clear();
-        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED,
-                               ZSTD_getErrorName(actualSize));
-    }
+        if (ZSTD_isError(actualSize)) {
+            m_decompressedData.clear();
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED,
+                                   ZSTD_getErrorName(actualSize));
+        }
 
-    if (actualSize != decompressedSize) {
-        m_decompressedData.clear();
-        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Decompressed size mismatch");
+        if (actualSize != decompressedSize) {
+            m_decompressedData.clear();
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Decompressed size mismatch");
+        }
     }
 
-    CompressionResult result;
-    result.original_size = actualSize;
-    result.compressed_size = m_compressedData.size();
+    result.original_size = m_decompressedData.size();
+    result.compressed_size = compressedSize;
     result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
     result.result_code = CompressResult::SUCCESS;
 
     return result;
 }
 
-bool ImageCompressor::saveCompressedData(const std::string& filename) const {
-    if (m_compressedData.empty()) return false;
+CompressionResult ImageCompressor::decodeRawImage(const unsigned char* src, size_t srcSize,
+                                                  unsigned char* dst, size_t dstStride) {
+    auto& ctx = getContext();
+    if (!skipPyramid(src, srcSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid pyramid index");
+    }
 
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) return false;
+    if (detail::isTiledImage(src, srcSize)) {
+        detail::TileIndex index;
+        size_t indexSize = 0;
+        if (!detail::readTileIndex(src, srcSize, srcSize, index, indexSize)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid tile index");
+        }
+        std::vector<const unsigned char*> tiles(index.tiles.size());
+        for (size_t i = 0; i < tiles.size(); ++i) {
+            tiles[i] = src + indexSize + index.tiles[i].offset;
+        }
+        return decodeTileRegion(index, tiles, m_ctx->ddict.get(), 0, 0, index.image.width, index.image.height, m_num_threads,
+                                dst, dstStride);
+    }
 
-    file.write(reinterpret_cast<const char*>(m_compressedData.data()), m_compressedData.size());
-    return file.good();
+    RawImageInfo info;
+    size_t headerSize = 0;
+    if (!detail::readRawHeader(src, srcSize, info, headerSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid raw image header");
+    }
+    return decompressRawFrame(ctx.dctx, ctx.ddict.get(), src + headerSize, srcSize - headerSize, info, m_workBuffer, dst, dstStride);
 }
 
-bool ImageCompressor::saveDecompressedImage(const std::string& filename) const {
-    if (m_decompressedData.empty()) return false;
-
-    std::ofstream file(filename, std::ios::binary);
+CompressionResult ImageCompressor::decompressToMat(const std::vector<unsigned char>& compressedData, cv::Mat& image) {
+    clearResults();
+    RawImageInfo info;
+    if (!peekImageInfo(compressedData.data(), compressedData.size(), info)) {
+        // 非 RAW 数据只能解压后再解码
+        m_compressedData = compressedData;
+        auto result = decompressInternal();
+        if (result.success()) image = getCVMat();
+        return result;
+    }
+
+    // 按头部分配（尺寸和类型相同时复用）cv::Mat，像素直接解压到它的内存
+    image.create(static_cast<int>(info.height), static_cast<int>(info.width),
+                 CV_MAKETYPE(info.depth == 16 ? CV_16U : CV_8U, info.channels));
+    auto result = decodeRawImage(compressedData.data(), compressedData.size(), image.data, image.step);
+    if (!result.success()) return result;
+    if (info.format == PixelFormat::PIXEL_RGB888) {
+        cv::cvtColor(image, image, cv::COLOR_RGB2BGR);
+    } else if (info.format == PixelFormat::PIXEL_RGBA8888) {
+        cv::cvtColor(image, image, cv::COLOR_RGBA2BGRA);
+    }
+
+    m_rawInfo = info;
+    result.original_size = info.dataSize();
+    result.compressed_size = compressedData.size();
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    return result;
+}
+
+CompressionResult ImageCompressor::decompressToQImage(const std::vector<unsigned char>& compressedData, QImage& image) {
+    clearResults();
+    RawImageInfo info;
+    if (!peekImageInfo(compressedData.data(), compressedData.size(), info)) {
+        m_compressedData = compressedData;
+        auto result = decompressInternal();
+        if (result.success()) image = getQImage();
+        return result;
+    }
+
+    const QImage::Format format = qImageFormat(info.format);
+    if (format == QImage::Format_Invalid) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "No matching QImage format");
+    }
+    if (image.width() != static_cast<int>(info.width) || image.height() != static_cast<int>(info.height)
+        || image.format() != format) {
+        image = QImage(static_cast<int>(info.width), static_cast<int>(info.height), format);
+        if (image.isNull()) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to allocate QImage");
+        }
+    }
+    auto result = decodeRawImage(compressedData.data(), compressedData.size(), image.bits(),
+                                 static_cast<size_t>(image.bytesPerLine()));
+    if (!result.success()) return result;
+    if (info.format == PixelFormat::PIXEL_BGR888) {
+        image = std::move(image).rgbSwapped();
+    }
+
+    m_rawInfo = info;
+    result.original_size = info.dataSize();
+    result.compressed_size = compressedData.size();
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    return result;
+}
+
+CompressionResult ImageCompressor::decompressRegion(int x, int y, int width, int height) {
+    if (m_compressedData.empty()) {
+        return CompressionResult(CompressResult::ERROR_EMPTY_DATA, "No compressed data");
+    }
+    const unsigned char* src = m_compressedData.data();
+    size_t srcSize = m_compressedData.size();
+    if (!skipPyramid(src, srcSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid pyramid index");
+    }
+    return decodeTiledRegion(src, srcSize, x, y, width, height);
+}
+
+CompressionResult ImageCompressor::decodeTiledRegion(const unsigned char* src, size_t srcSize,
+                                                     int x, int y, int width, int height) {
+    detail::TileIndex index;
+    size_t indexSize = 0;
+    if (!detail::readTileIndex(src, srcSize, srcSize, index, indexSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Not a tiled image");
+    }
+    uint32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    if (!clipRegion(index.image, x, y, width, height, x0, y0, x1, y1)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Region outside image");
+    }
+
+    // 只为与区域相交的块给出数据指针
+    std::vector<const unsigned char*> tiles(index.tiles.size(), nullptr);
+    size_t compressedSize = indexSize;
+    const uint32_t columns = index.columns();
+    for (uint32_t row = y0 / index.tileHeight; row <= (y1 - 1) / index.tileHeight; ++row) {
+        for (uint32_t column = x0 / index.tileWidth; column <= (x1 - 1) / index.tileWidth; ++column) {
+            const detail::TileFrame& tile = index.tiles[row * columns + column];
+            tiles[row * columns + column] = src + indexSize + tile.offset;
+            compressedSize += tile.size;
+        }
+    }
+
+    m_qImage = QImage();
+    m_cvMat = cv::Mat();
+    m_rawInfo = regionInfo(index, x0, y0, x1, y1);
+    m_decompressedData.resize(m_rawInfo.dataSize());
+    auto result = decodeTileRegion(index, tiles, m_ctx->ddict.get(), x0, y0, x1, y1, m_num_threads,
+                                   m_decompressedData.data(), m_rawInfo.stride);
+    if (!result.success()) {
+        m_decompressedData.clear();
+        m_rawInfo = RawImageInfo();
+        return result;
+    }
+    result.original_size = m_decompressedData.size();
+    result.compressed_size = compressedSize;
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    return result;
+}
+
+CompressionResult ImageCompressor::decompressRegion(const std::string& filename, int x, int y,
+                                                    int width, int height) {
+    clearResults();
+    std::ifstream file(filename, std::ios::binary);
+    detail::TileIndex index;
+    size_t indexSize = 0;
+    uint64_t base = 0;
+    uint64_t size = 0;
+    if (!file.is_open() || !locateFullResolution(file, base, size) || !readTileIndex(file, base, size, index, indexSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid tiled image file");
+    }
+    uint32_t x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+    if (!clipRegion(index.image, x, y, width, height, x0, y0, x1, y1)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Region outside image");
+    }
+
+    // 只读取与区域相交的块，其余数据不进入内存
+    std::vector<std::vector<unsigned char>> tileData(index.tiles.size());
+    std::vector<const unsigned char*> tiles(index.tiles.size(), nullptr);
+    size_t compressedSize = indexSize;
+    const uint32_t columns = index.columns();
+    for (uint32_t row = y0 / index.tileHeight; row <= (y1 - 1) / index.tileHeight; ++row) {
+        for (uint32_t column = x0 / index.tileWidth; column <= (x1 - 1) / index.tileWidth; ++column) {
+            const size_t i = row * columns + column;
+            if (!readFileRange(file, base + indexSize + index.tiles[i].offset, index.tiles[i].size, tileData[i])) {
+                return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to read tile");
+            }
+            tiles[i] = tileData[i].data();
+            compressedSize += tileData[i].size();
+        }
+    }
+
+    m_rawInfo = regionInfo(index, x0, y0, x1, y1);
+    m_decompressedData.resize(m_rawInfo.dataSize());
+    auto result = decodeTileRegion(index, tiles, m_ctx->ddict.get(), x0, y0, x1, y1, m_num_threads,
+                                   m_decompressedData.data(), m_rawInfo.stride);
+    if (!result.success()) {
+        m_decompressedData.clear();
+        m_rawInfo = RawImageInfo();
+        return result;
+    }
+    result.original_size = m_decompressedData.size();
+    result.compressed_size = compressedSize;
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    return result;
+}
+
+RawImageInfo ImageCompressor::getTiledImageInfo(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    detail::TileIndex index;
+    size_t indexSize = 0;
+    uint64_t base = 0;
+    uint64_t size = 0;
+    if (!file.is_open() || !locateFullResolution(file, base, size) || !readTileIndex(file, base, size, index, indexSize)) {
+        return RawImageInfo();
+    }
+    return index.image;
+}
+
+CompressionResult ImageCompressor::decompressLevel(int level) {
+    if (m_compressedData.empty()) {
+        return CompressionResult(CompressResult::ERROR_EMPTY_DATA, "No compressed data");
+    }
+    if (level == 0) return decompressInternal();
+
+    detail::PyramidIndex index;
+    size_t indexSize = 0;
+    if (!detail::readPyramidIndex(m_compressedData.data(), m_compressedData.size(), m_compressedData.size(),
+                                  index, indexSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Not an image pyramid");
+    }
+    const detail::PyramidLevel* entry = level > 0 ? index.find(static_cast<uint32_t>(level)) : nullptr;
+    if (!entry) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Pyramid level out of range");
+    }
+    m_decompressedData.clear();
+    m_rawInfo = RawImageInfo();
+    m_qImage = QImage();
+    m_cvMat = cv::Mat();
+    return decodeImageData(m_compressedData.data() + indexSize + entry->offset, static_cast<size_t>(entry->size));
+}
+
+CompressionResult ImageCompressor::decompressLevel(const std::string& filename, int level) {
+    clearResults();
+    std::ifstream file(filename, std::ios::binary);
+    detail::PyramidIndex index;
+    size_t indexSize = 0;
+    if (!file.is_open() || !readPyramidIndex(file, index, indexSize)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid image pyramid file");
+    }
+    const detail::PyramidLevel* entry = level >= 0 ? index.find(static_cast<uint32_t>(level)) : nullptr;
+    if (!entry) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Pyramid level out of range");
+    }
+
+    // 只读取这一层的数据：缩略图层位于文件开头，通常只有几 KB
+    if (!readFileRange(file, indexSize + entry->offset, static_cast<size_t>(entry->size), m_compressedData)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to read pyramid level");
+    }
+    return decompressInternal();
+}
+
+int ImageCompressor::getPyramidLevelCount(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    detail::PyramidIndex index;
+    size_t indexSize = 0;
+    if (!file.is_open() || !readPyramidIndex(file, index, indexSize)) return 0;
+    return static_cast<int>(index.levels.size());
+}
+
+bool ImageCompressor::saveCompressedData(const std::string& filename) const {
+    if (m_compressedData.empty()) return false;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    file.write(reinterpret_cast<const char*>(m_compressedData.data()), m_compressedData.size());
+    return file.good();
+}
+
+bool ImageCompressor::saveDecompressedImage(const std::string& filename) const {
+    if (m_decompressedData.empty()) return false;
+
+    if (m_rawInfo.valid()) {
+        // RAW 数据没有容器：BGR 顺序的 8 位像素直接写 BMP（BGRX 写成 BI_RGB 32 位，第 4 字节即保留字节），
+        // 其它按扩展名交给 OpenCV 编码
+        const std::string extension = std::filesystem::path(filename).extension().string();
+        const bool bgrLayout = m_rawInfo.format == PixelFormat::PIXEL_GRAY8
+            || m_rawInfo.format == PixelFormat::PIXEL_BGR888 || m_rawInfo.format == PixelFormat::PIXEL_BGRA8888
+            || m_rawInfo.format == PixelFormat::PIXEL_BGRX8888;
+        if (extension == ".bmp" && bgrLayout) {
+            std::vector<unsigned char> bmp;
+            if (!detail::writeBmp(m_decompressedData.data(), m_rawInfo.stride, m_rawInfo.width,
+                                  m_rawInfo.height, m_rawInfo.channels,
+                                  m_rawInfo.format == PixelFormat::PIXEL_BGRA8888, bmp)) {
+                return false;
+            }
+            std::ofstream file(filename, std::ios::binary);
+            file.write(reinterpret_cast<const char*>(bmp.data()), static_cast<std::streamsize>(bmp.size()));
+            return file.good();
+        }
+        try {
+            return cv::imwrite(filename, getCVMat());
+        } catch (const cv::Exception&) {
+            return false;
+        }
+    }
+
+    std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) return false;
 
     file.write(reinterpret_cast<const char*>(m_decompressedData.data()), m_decompressedData.size());
@@ -287,16 +1457,32 @@ bool ImageCompressor::saveDecompressedImage(const std::string& filename) const {
 }
 
 QImage ImageCompressor::getQImage() const {
-    if (m_qImage.isNull() && !m_decompressedData.empty()) {
-        m_qImage.loadFromData(m_decompressedData.data(), static_cast<int>(m_decompressedData.size()));
+    if (m_qImage.isNull()) {
+        if (!m_decompressedData.empty()) {
+            m_qImage = m_rawInfo.valid()
+                ? rawToQImage(m_rawInfo, m_decompressedData.data(), m_rawInfo.stride)
+                : decodeQImage(m_decompressedData);
+        } else if (!m_originalData.empty()) {
+            m_qImage = decodeQImage(m_originalData);
+        } else if (!m_rawFileData.empty()) {
+            m_qImage = rawToQImage(m_originalInfo, m_rawSource.data, m_rawSource.step);
+        }
     }
     return m_qImage;
 }
 
 cv::Mat ImageCompressor::getCVMat() const {
-    if (m_cvMat.empty() && !m_decompressedData.empty()) {
+    if (m_cvMat.empty()) {
         try {
-            m_cvMat = cv::imdecode(m_decompressedData, cv::IMREAD_UNCHANGED);
+            if (!m_decompressedData.empty()) {
+                m_cvMat = m_rawInfo.valid()
+                    ? rawToCVMat(m_rawInfo, m_decompressedData.data(), m_rawInfo.stride)
+                    : decodeCVMat(m_decompressedData);
+            } else if (!m_originalData.empty()) {
+                m_cvMat = decodeCVMat(m_originalData);
+            } else if (!m_rawFileData.empty()) {
+                m_cvMat = m_rawSource.clone();
+            }
         } catch (const cv::Exception& e) {
             // 记录错误但不抛出异常
         }
@@ -304,6 +1490,30 @@ cv::Mat ImageCompressor::getCVMat() const {
     return m_cvMat;
 }
 
+QImage ImageCompressor::decodeQImage(const std::vector<unsigned char>& data) {
+    detail::BmpImage bmp;
+    if (detail::readBmp(data.data(), data.size(), bmp)) {
+        return rawToQImage(bmpInfo(bmp), bmp.pixels, bmp.stride);
+    }
+    QImage image;
+    image.loadFromData(data.data(), static_cast<int>(data.size()));
+    return image;
+}
+
+cv::Mat ImageCompressor::decodeCVMat(const std::vector<unsigned char>& data) {
+    detail::BmpImage bmp;
+    if (detail::readBmp(data.data(), data.size(), bmp)) {
+        const RawImageInfo info = bmpInfo(bmp);
+        cv::Mat mat = rawToCVMat(info, bmp.pixels, bmp.stride);
+        // 与 cv::imdecode 一致：没有 Alpha 的 32 位 BMP 解码为 3 通道
+        if (info.format == PixelFormat::PIXEL_BGRX8888) {
+            cv::cvtColor(mat, mat, cv::COLOR_BGRA2BGR);
+        }
+        return mat;
+    }
+    return cv::imdecode(data, cv::IMREAD_UNCHANGED);
+}
+
 const std::vector<unsigned char>& ImageCompressor::getCompressedData() const {
     return m_compressedData;
 }
@@ -312,8 +1522,16 @@ const std::vector<unsigned char>& ImageCompressor::getDecompressedData() const {
     return m_decompressedData;
 }
 
+const RawImageInfo& ImageCompressor::getRawImageInfo() const {
+    return m_rawInfo;
+}
+
+bool ImageCompressor::isRawImage() const {
+    return m_rawInfo.valid();
+}
+
 CompressionResult ImageCompressor::compressFolder(const std::string& inputFolder,
-                                                 const std::string& outputFolder) {
+                                                 const std::string& outputFolder, int numWorkers) {
     try {
         if (!std::filesystem::create_directories(outputFolder) &&
             !std::filesystem::exists(outputFolder)) {
@@ -321,21 +1539,30 @@ CompressionResult ImageCompressor::compressFolder(const std::string& inputFolder
         }
 
         const auto imageFiles = getImageFiles(inputFolder);
-        size_t total_original = 0, total_compressed = 0;
-        size_t success_count = 0;
+        // 每个工作线程只累加自己的统计，结束后再求和，不需要原子操作也不会丢失计数
+        std::vector<CompressionResult> totals(static_cast<size_t>(std::max(numWorkers, 1)));
+        std::vector<size_t> successes(totals.size(), 0);
 
-        for (const auto& file : imageFiles) {
+        forEachParallel(imageFiles.size(), numWorkers, [&](ImageCompressor& compressor, size_t worker, size_t i) {
             const std::string outputFile = outputFolder + "/" +
-                std::filesystem::path(file).stem().string() + ".zstd";
-
-            if (loadImage(file)) {
-                auto result = compressInternal();
-                if (result.success() && saveCompressedData(outputFile)) {
-                    total_original += result.original_size;
-                    total_compressed += result.compressed_size;
-                    success_count++;
+                std::filesystem::path(imageFiles[i]).stem().string() + ".zstd";
+
+            if (compressor.loadImage(imageFiles[i])) {
+                auto result = compressor.compressInternal();
+                if (result.success() && compressor.saveCompressedData(outputFile)) {
+                    totals[worker].original_size += result.original_size;
+                    totals[worker].compressed_size += result.compressed_size;
+                    successes[worker]++;
                 }
             }
+        });
+
+        size_t total_original = 0, total_compressed = 0;
+        size_t success_count = 0;
+        for (size_t w = 0; w < totals.size(); ++w) {
+            total_original += totals[w].original_size;
+            total_compressed += totals[w].compressed_size;
+            success_count += successes[w];
         }
 
         if (success_count == 0) {
@@ -356,24 +1583,267 @@ CompressionResult ImageCompressor::compressFolder(const std::string& inputFolder
 }
 
 CompressionResult ImageCompressor::decompressFolder(const std::string& inputFolder,
-                                                   const std::string& outputFolder) {
+                                                   const std::string& outputFolder, int numWorkers) {
     try {
         if (!std::filesystem::create_directories(outputFolder) &&
             !std::filesystem::exists(outputFolder)) {
             return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Cannot create output directory");
         }
 
-        size_t success_count = 0;
-
+        std::vector<std::filesystem::path> compressedFiles;
         for (const auto& entry : std::filesystem::directory_iterator(inputFolder)) {
             if (entry.is_regular_file() && isCompressedFile(entry.path().string())) {
-                const std::string outputFile = outputFolder + "/" +
-                    entry.path().stem().string() + ".bmp";
+                compressedFiles.push_back(entry.path());
+            }
+        }
+
+        std::vector<CompressionResult> totals(static_cast<size_t>(std::max(numWorkers, 1)));
+        std::vector<size_t> successes(totals.size(), 0);
+
+        forEachParallel(compressedFiles.size(), numWorkers, [&](ImageCompressor& compressor, size_t worker, size_t i) {
+            const std::string outputFile = outputFolder + "/" +
+                compressedFiles[i].stem().string() + ".bmp";
+
+            auto result = compressor.decompressFromFile(compressedFiles[i].string());
+            if (result.success() && compressor.saveDecompressedImage(outputFile)) {
+                totals[worker].original_size += result.original_size;
+                totals[worker].compressed_size += result.compressed_size;
+                successes[worker]++;
+            }
+        });
+
+        size_t total_original = 0, total_compressed = 0;
+        size_t success_count = 0;
+        for (size_t w = 0; w < totals.size(); ++w) {
+            total_original += totals[w].original_size;
+            total_compressed += totals[w].compressed_size;
+            success_count += successes[w];
+        }
+
+        if (success_count == 0) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "No files processed successfully");
+        }
+
+        CompressionResult result;
+        result.original_size = total_original;
+        result.compressed_size = total_compressed;
+        result.compression_ratio = static_cast<double>(total_compressed) / total_original;
+        result.result_code = CompressResult::SUCCESS;
+
+        return result;
+
+    } catch (const std::exception& e) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, e.what());
+    }
+}
+
+void ImageCompressor::copySettingsTo(ImageCompressor& other) const {
+    other.m_level = m_level;
+    other.m_num_threads = m_num_threads;
+    other.m_format = m_format;
+    other.m_colorTransform = m_colorTransform;
+    other.m_filterMode = m_filterMode;
+    other.m_planarLayout = m_planarLayout;
+    other.m_planarGainEstimate = m_planarGainEstimate;
+    other.m_shuffleMode = m_shuffleMode;
+    other.m_paletteMode = m_paletteMode;
+    other.m_channelReduction = m_channelReduction;
+    other.m_constantTiles = m_constantTiles;
+    other.m_keyframeInterval = m_keyframeInterval;
+    other.m_rowMatchFinder = m_rowMatchFinder;
+    other.m_tileSize = m_tileSize;
+    other.m_bandRows = m_bandRows;
+    other.m_pyramidLevels = m_pyramidLevels;
+    other.m_solidBlockSize = m_solidBlockSize;
+    other.m_longDistanceMatching = m_longDistanceMatching;
+    other.m_similarityGrouping = m_similarityGrouping;
+    // 字典内容、DDict 和校验和与本实例共用（注册表中的字典本来就是共享映射），CDict 来自全局缓存：
+    // 工作实例不复制字典，也不重新计算校验和
+    other.clearDictionary();
+    other.m_dictionary = m_dictionary;
+    other.m_dictData = m_dictData;
+    other.m_dictSize = m_dictSize;
+    other.m_dictChecksum = m_dictChecksum;
+    other.m_ctx->ddict = m_ctx->ddict;
+}
+
+void ImageCompressor::forEachParallel(size_t count, int numWorkers,
+                                      const std::function<void(ImageCompressor&, size_t, size_t)>& task) {
+    const size_t workers = std::min(static_cast<size_t>(std::max(numWorkers, 1)), count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) task(*this, 0, i);
+        return;
+    }
+
+    // 文件之间已经并行，每个实例在自己的工作线程内单线程压缩（nbWorkers = 0，不经过 ZSTDMT 和共享线程池），
+    // 避免线程数成倍超过核心数，也不受线程池大小限制
+    std::vector<std::unique_ptr<ImageCompressor>> compressors;
+    for (size_t w = 0; w < workers; ++w) {
+        compressors.push_back(std::make_unique<ImageCompressor>(m_level));
+        copySettingsTo(*compressors.back());
+        compressors.back()->m_num_threads = 0;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&](size_t w) {
+        for (size_t i = next++; i < count; i = next++) {
+            try {
+                task(*compressors[w], w, i);
+            } catch (const std::exception&) {
+                // 单个文件失败不影响其它文件，不计入成功数
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (size_t w = 1; w < workers; ++w) threads.emplace_back(worker, w);
+    worker(0);
+    for (auto& thread : threads) thread.join();
+}
+
+CompressionResult ImageCompressor::compressFolderToPack(const std::string& inputFolder,
+                                                       const std::string& packFile) {
+    try {
+        // 相似度分组时同组的图像相邻，groupStart 标记每组的第一个文件
+        std::vector<std::string> imageFiles;
+        std::vector<bool> groupStart;
+        if (m_similarityGrouping) {
+            for (const auto& group : clusterImageFiles(inputFolder, m_num_threads)) {
+                for (size_t i = 0; i < group.size(); ++i) {
+                    imageFiles.push_back(group[i]);
+                    groupStart.push_back(i == 0);
+                }
+            }
+        } else {
+            imageFiles = getImageFiles(inputFolder);
+            groupStart.assign(imageFiles.size(), false);
+        }
+        std::ofstream file(packFile, std::ios::binary);
+        if (!file.is_open()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Cannot create pack file");
+        }
 
-                auto result = decompressFromFile(entry.path().string());
-                if (result.success() && saveDecompressedImage(outputFile)) {
-                    success_count++;
+        std::vector<detail::PackEntry> entries;
+        uint64_t offset = 0;
+        size_t total_original = 0;
+
+        // 固实块：成员依次追加到 block，块满时整体压缩，等待中的条目再填写块的位置
+        std::vector<unsigned char> block;
+        std::vector<unsigned char> member;
+        std::vector<detail::PackEntry> pending;
+        auto flushBlock = [&]() -> bool {
+            if (block.empty()) return true;
+            if (!compressSolidBlock(block, m_compressedData).success()) return false;
+            file.write(reinterpret_cast<const char*>(m_compressedData.data()),
+                       static_cast<std::streamsize>(m_compressedData.size()));
+            if (!file.good()) return false;
+            const uint32_t dictID = detail::frameDictID(m_compressedData.data(), m_compressedData.size());
+            for (auto& entry : pending) {
+                entry.offset = offset;
+                entry.size = m_compressedData.size();
+                entry.dictID = dictID;
+                entries.push_back(std::move(entry));
+            }
+            pending.clear();
+            block.clear();
+            offset += m_compressedData.size();
+            return true;
+        };
+
+        for (size_t n = 0; n < imageFiles.size(); ++n) {
+            const std::string& imageFile = imageFiles[n];
+            if (!loadImage(imageFile)) continue;
+
+            // 超过块大小的图像仍单独压缩（保留分块、金字塔等设置）；新的一组开始时，
+            // 已过半的块先压缩，避免不相似的图像共用窗口
+            const size_t blockSize = static_cast<size_t>(m_solidBlockSize);
+            if (blockSize > 0 && buildSolidMember(member) && member.size() < blockSize) {
+                const bool full = block.size() + member.size() > blockSize
+                    || (groupStart[n] && block.size() >= blockSize / 2);
+                if (full && !flushBlock()) {
+                    return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write solid block");
                 }
+                detail::PackEntry entry;
+                entry.name = std::filesystem::path(imageFile).filename().string();
+                entry.checksum = detail::packChecksum(member.data(), member.size());
+                entry.memberOffset = block.size();
+                entry.memberSize = member.size();
+                pending.push_back(std::move(entry));
+                block.insert(block.end(), member.begin(), member.end());
+                total_original += m_originalInfo.valid() ? m_originalInfo.dataSize() : m_originalData.size();
+                continue;
+            }
+
+            const auto result = compressInternal();
+            if (!result.success()) continue;
+
+            file.write(reinterpret_cast<const char*>(m_compressedData.data()),
+                       static_cast<std::streamsize>(m_compressedData.size()));
+            if (!file.good()) {
+                return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write pack file");
+            }
+
+            detail::PackEntry entry;
+            entry.name = std::filesystem::path(imageFile).filename().string();
+            entry.offset = offset;
+            entry.size = m_compressedData.size();
+            entry.checksum = detail::packChecksum(m_compressedData.data(), m_compressedData.size());
+            entry.dictID = detail::frameDictID(m_compressedData.data(), m_compressedData.size());
+            entries.push_back(std::move(entry));
+            offset += m_compressedData.size();
+            total_original += result.original_size;
+        }
+        if (!flushBlock()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write solid block");
+        }
+
+        if (entries.empty()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "No files processed successfully");
+        }
+
+        std::vector<unsigned char> indexData;
+        if (detail::writePackIndex(entries, indexData) == 0) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write pack index");
+        }
+        file.write(reinterpret_cast<const char*>(indexData.data()), static_cast<std::streamsize>(indexData.size()));
+        if (!file.good()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write pack file");
+        }
+
+        CompressionResult result;
+        result.original_size = total_original;
+        result.compressed_size = offset + indexData.size();
+        result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+        result.result_code = CompressResult::SUCCESS;
+        return result;
+
+    } catch (const std::exception& e) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, e.what());
+    }
+}
+
+CompressionResult ImageCompressor::decompressPack(const std::string& packFile, const std::string& outputFolder) {
+    try {
+        if (!std::filesystem::create_directories(outputFolder) &&
+            !std::filesystem::exists(outputFolder)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Cannot create output directory");
+        }
+        if (!openPack(packFile)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid pack file");
+        }
+
+        size_t total_original = 0, total_compressed = 0;
+        size_t success_count = 0;
+        detail::PackEntry entry;
+        for (size_t i = 0; i < m_pack->index.count(); ++i) {
+            if (!m_pack->index.entry(i, entry)) continue;
+            const std::string outputFile = outputFolder + "/" +
+                std::filesystem::path(entry.name).stem().string() + ".bmp";
+
+            auto result = decodePackEntry(entry);
+            if (result.success() && saveDecompressedImage(outputFile)) {
+                total_original += result.original_size;
+                total_compressed += result.compressed_size;
+                success_count++;
             }
         }
 
@@ -381,6 +1851,508 @@ CompressionResult ImageCompressor::decompressFolder(const std::string& inputFold
             return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "No files processed successfully");
         }
 
+        CompressionResult result;
+        result.original_size = total_original;
+        result.compressed_size = total_compressed;
+        result.compression_ratio = static_cast<double>(total_compressed) / total_original;
+        result.result_code = CompressResult::SUCCESS;
+
+        return result;
+
+    } catch (const std::exception& e) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, e.what());
+    }
+}
+
+bool ImageCompressor::openPack(const std::string& packFile) {
+    auto pack = std::make_unique<detail::PackReader>();
+    if (!pack->file.open(packFile) || !pack->index.open(pack->file.data(), pack->file.size())) {
+        return false;
+    }
+    m_pack = std::move(pack);
+    return true;
+}
+
+void ImageCompressor::closePack() {
+    m_pack.reset();
+}
+
+CompressionResult ImageCompressor::readEntry(const std::string& name) {
+    clearResults();
+    if (!m_pack) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "No pack file opened");
+    }
+    detail::PackEntry entry;
+    if (!m_pack->index.find(name, entry)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Entry not found");
+    }
+    return decodePackEntry(entry);
+}
+
+std::vector<std::string> ImageCompressor::getPackEntryNames() const {
+    std::vector<std::string> names;
+    if (!m_pack) return names;
+    names.reserve(m_pack->index.count());
+    detail::PackEntry entry;
+    for (size_t i = 0; i < m_pack->index.count(); ++i) {
+        if (m_pack->index.entry(i, entry)) names.push_back(entry.name);
+    }
+    return names;
+}
+
+bool ImageCompressor::buildSolidMember(std::vector<unsigned char>& member) {
+    // 成员为 RAW 头部 + 预处理后的像素，或原始的图像文件数据；压缩留给整个块
+    member.clear();
+    RawImageInfo info = m_originalInfo;
+    if (!info.valid()) {
+        member.assign(m_originalData.begin(), m_originalData.end());
+        return !member.empty();
+    }
+    const unsigned char* input = nullptr;
+    size_t inputSize = 0;
+    if (!prepareRawPayload(info, m_rawSource.data, m_rawSource.step, m_workBuffer, input, inputSize)
+        || detail::writeRawHeader(info, member) == 0) {
+        return false;
+    }
+    member.insert(member.end(), input, input + inputSize);
+    return true;
+}
+
+CompressionResult ImageCompressor::compressSolidBlock(const std::vector<unsigned char>& block,
+                                                      std::vector<unsigned char>& out) {
+    auto& ctx = getContext();
+    if (!ctx.cctx) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to create compression context");
+    }
+
+    size_t configured = configureContext(ctx.cctx, m_level, m_num_threads, ctx.cdict.get());
+    if (m_longDistanceMatching && !ZSTD_isError(configured)) {
+        // 窗口取能覆盖整个块的最小值，但不超过解压端默认接受的上限（ZSTD_WINDOWLOG_LIMIT_DEFAULT）
+        constexpr int kMinWindowLog = 10;
+        constexpr int kMaxWindowLog = 27;
+        int windowLog = kMinWindowLog;
+        while (windowLog < kMaxWindowLog && (size_t(1) << windowLog) < block.size()) ++windowLog;
+        configured = ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_enableLongDistanceMatching, 1);
+        if (!ZSTD_isError(configured)) configured = ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_windowLog, windowLog);
+    }
+
+    out.resize(ZSTD_compressBound(block.size()));
+    const size_t compressedSize = ZSTD_isError(configured) ? configured
+        : ZSTD_compress2(ctx.cctx, out.data(), out.size(), block.data(), block.size());
+    if (m_longDistanceMatching) {
+        ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_enableLongDistanceMatching, 0);
+        ZSTD_CCtx_setParameter(ctx.cctx, ZSTD_c_windowLog, 0);
+    }
+
+    if (ZSTD_isError(compressedSize)) {
+        out.clear();
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, ZSTD_getErrorName(compressedSize));
+    }
+    out.resize(compressedSize);
+    return CompressionResult(CompressResult::SUCCESS);
+}
+
+CompressionResult ImageCompressor::decodePackEntry(const detail::PackEntry& entry) {
+    clearResults();
+    // 直接从映射内存解压，压缩数据不复制到 m_compressedData
+    const unsigned char* src = m_pack->file.data() + entry.offset;
+    const size_t size = static_cast<size_t>(entry.size);
+    if (!entry.solid()) {
+        if (detail::packChecksum(src, size) != entry.checksum) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Pack entry checksum mismatch: " + entry.name);
+        }
+        return decodeImageData(src, size);
+    }
+
+    // 固实条目：解压（或复用缓存的）整个块，再取出成员
+    auto& block = m_pack->block;
+    if (m_pack->blockOffset != entry.offset) {
+        m_pack->blockOffset = UINT64_MAX;
+        const size_t blockSize = ZSTD_getFrameContentSize(src, size);
+        if (blockSize == ZSTD_CONTENTSIZE_ERROR || blockSize == ZSTD_CONTENTSIZE_UNKNOWN) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid solid block");
+        }
+        block.resize(blockSize);
+        auto& ctx = getContext();
+        const size_t actualSize = decompressFrame(ctx.dctx, block.data(), blockSize, src, size, ctx.ddict.get());
+        if (ZSTD_isError(actualSize)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, ZSTD_getErrorName(actualSize));
+        }
+        if (actualSize != blockSize) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Decompressed size mismatch");
+        }
+        m_pack->blockOffset = entry.offset;
+    }
+    if (entry.memberOffset > block.size() || entry.memberSize > block.size() - entry.memberOffset) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Pack entry outside solid block: " + entry.name);
+    }
+    const unsigned char* member = block.data() + entry.memberOffset;
+    const size_t memberSize = static_cast<size_t>(entry.memberSize);
+    if (detail::packChecksum(member, memberSize) != entry.checksum) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Pack entry checksum mismatch: " + entry.name);
+    }
+
+    auto result = decodeSolidMember(member, memberSize);
+    if (result.success()) {
+        // 块的压缩长度按成员在块中所占比例分摊
+        result.compressed_size = static_cast<size_t>(entry.size * entry.memberSize / block.size());
+        result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    }
+    return result;
+}
+
+CompressionResult ImageCompressor::decodeSolidMember(const unsigned char* src, size_t size) {
+    if (detail::isRawImageFrame(src, size)) {
+        RawImageInfo info;
+        size_t headerSize = 0;
+        if (!detail::readRawHeader(src, size, info, headerSize)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid raw image header");
+        }
+        m_decompressedData.resize(info.dataSize());
+        auto restored = restoreRawPixels(info, src + headerSize, size - headerSize,
+                                         m_decompressedData.data(), info.stride);
+        if (!restored.success()) {
+            m_decompressedData.clear();
+            return restored;
+        }
+        m_rawInfo = info;
+    } else {
+        m_decompressedData.assign(src, src + size);
+    }
+
+    CompressionResult result;
+    result.original_size = m_decompressedData.size();
+    result.compressed_size = size;
+    result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+    result.result_code = CompressResult::SUCCESS;
+    return result;
+}
+
+CompressionResult ImageCompressor::trainDictionary(const std::string& sampleFolder, const std::string& dictFile,
+                                                  size_t maxDictSize) {
+    return trainDictionary(getImageFiles(sampleFolder), dictFile, maxDictSize);
+}
+
+CompressionResult ImageCompressor::trainDictionary(const std::vector<std::string>& sampleFiles,
+                                                  const std::string& dictFile, size_t maxDictSize) {
+    try {
+        std::vector<unsigned char> samples;
+        std::vector<size_t> sizes;
+        for (const auto& sampleFile : sampleFiles) {
+            if (!loadImage(sampleFile)) continue;
+
+            // 样本与压缩时送入 zstd 的数据一致：RAW 模式为预处理后的像素，其它为图像文件数据
+            const unsigned char* input = m_originalData.data();
+            size_t inputSize = m_originalData.size();
+            RawImageInfo info = m_originalInfo;
+            if (info.valid() && !prepareRawPayload(info, m_rawSource.data, m_rawSource.step, m_workBuffer,
+                                                   input, inputSize)) {
+                continue;
+            }
+            inputSize = std::min(inputSize, detail::kMaxDictionarySampleBytes);
+            if (inputSize == 0) continue;
+            samples.insert(samples.end(), input, input + inputSize);
+            sizes.push_back(inputSize);
+        }
+        if (sizes.empty()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "No samples loaded");
+        }
+
+        std::vector<unsigned char> dictionary;
+        std::string error;
+        if (!detail::trainDictionary(samples.data(), sizes, maxDictSize, m_level, m_num_threads, dictionary, error)) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, error);
+        }
+
+        std::ofstream file(dictFile, std::ios::binary);
+        if (!file.is_open()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Cannot create dictionary file");
+        }
+        file.write(reinterpret_cast<const char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+        if (!file.good()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write dictionary file");
+        }
+        if (!loadDictionary(dictionary)) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to load trained dictionary");
+        }
+
+        CompressionResult result;
+        result.original_size = samples.size();
+        result.compressed_size = dictionary.size();
+        result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+        result.result_code = CompressResult::SUCCESS;
+        return result;
+
+    } catch (const std::exception& e) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, e.what());
+    }
+}
+
+bool ImageCompressor::loadDictionary(const std::string& dictFile) {
+    std::ifstream file(dictFile, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    const auto size = file.tellg();
+    if (size <= 0) return false;
+    file.seekg(0, std::ios::beg);
+    std::vector<unsigned char> dictionary(static_cast<size_t>(size));
+    if (!file.read(reinterpret_cast<char*>(dictionary.data()), size)) return false;
+    return loadDictionary(dictionary);
+}
+
+bool ImageCompressor::loadDictionary(const std::vector<unsigned char>& dictionary) {
+    if (dictionary.empty()) return false;
+    ZSTD_DDict* ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+    if (!ddict) return false;
+
+    clearDictionary();
+    m_dictionary = std::make_shared<const std::vector<unsigned char>>(dictionary);
+    m_dictData = m_dictionary->data();
+    m_dictSize = m_dictionary->size();
+    m_dictChecksum = detail::dictionaryChecksum(m_dictData, m_dictSize);
+    m_ctx->ddict.reset(ddict, [](const ZSTD_DDict* p) {
+        ZSTD_freeDDict(const_cast<ZSTD_DDict*>(p));
+    });
+    // CDict 在 getContext() 中按当前压缩级别构建
+    auto& ctx = getContext();
+    if (!ctx.cdict) {
+        clearDictionary();
+        return false;
+    }
+    return true;
+}
+
+void ImageCompressor::clearDictionary() {
+    // 引用 NULL 即回到无字典模式，之后才能释放 CDict
+    if (m_ctx->cctx) detail::referenceCDict(m_ctx->cctx, nullptr);
+    m_ctx->cdict.reset();
+    m_ctx->ddict.reset();
+    m_dictionary.reset();
+    m_dictData = nullptr;
+    m_dictSize = 0;
+    m_dictChecksum = 0;
+}
+
+bool ImageCompressor::useRegisteredDictionary(unsigned dictID) {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    if (!detail::DictionaryRegistry::instance().content(dictID, data, size)) return false;
+
+    // 解压由注册表按帧中的字典 ID 选择 DDict，这里只需要压缩端的 CDict
+    clearDictionary();
+    m_dictData = data;
+    m_dictSize = size;
+    m_dictChecksum = detail::dictionaryChecksum(data, size);
+    if (!getContext().cdict) {
+        clearDictionary();
+        return false;
+    }
+    return true;
+}
+
+unsigned ImageCompressor::getDictionaryID() const {
+    return m_dictData ? ZSTD_getDictID_fromDict(m_dictData, m_dictSize) : 0;
+}
+
+unsigned ImageCompressor::registerDictionary(const std::string& dictFile) {
+    return detail::DictionaryRegistry::instance().add(dictFile);
+}
+
+size_t ImageCompressor::registerDictionaries(const std::string& folder) {
+    size_t count = 0;
+    try {
+        for (const auto& entry : std::filesystem::directory_iterator(folder)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".dict"
+                && registerDictionary(entry.path().string()) != 0) {
+                count++;
+            }
+        }
+    } catch (const std::exception&) {
+        // 记录错误但不抛出异常
+    }
+    return count;
+}
+
+std::vector<unsigned> ImageCompressor::getRegisteredDictionaryIDs() {
+    return detail::DictionaryRegistry::instance().ids();
+}
+
+void ImageCompressor::clearDictionaryCache() {
+    detail::CDictCache::instance().clear();
+}
+
+bool ImageCompressor::enableDictionaryRetraining(const std::string& dictFolder, double degradation,
+                                                 size_t reservoirSamples) {
+    return detail::DictionaryMonitor::instance().enable(dictFolder, degradation, reservoirSamples);
+}
+
+void ImageCompressor::disableDictionaryRetraining() {
+    detail::DictionaryMonitor::instance().disable();
+}
+
+void ImageCompressor::waitForDictionaryRetraining() {
+    detail::DictionaryMonitor::instance().wait();
+}
+
+CompressionResult ImageCompressor::compressSequence(const std::string& inputFolder,
+                                                   const std::string& outputFile) {
+    if (m_format != ImageFormat::FORMAT_RAW) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Sequence mode requires FORMAT_RAW");
+    }
+    try {
+        const auto imageFiles = getImageFiles(inputFolder);
+        std::ofstream file(outputFile, std::ios::binary);
+        if (!file.is_open()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Cannot create output file");
+        }
+
+        detail::SequenceIndex index;
+        index.keyframeInterval = static_cast<uint32_t>(m_keyframeInterval);
+        RawImageInfo referenceInfo;
+        std::vector<unsigned char> current;
+        size_t sinceKeyframe = 0;
+        uint64_t offset = 0;
+        size_t total_original = 0;
+
+        for (const auto& imageFile : imageFiles) {
+            if (!loadImage(imageFile) || !m_originalInfo.valid()) continue;
+
+            // 尺寸或格式变化时强制插入关键帧
+            const RawImageInfo info = m_originalInfo;
+            const bool keyframe = index.frames.empty() || sinceKeyframe >= static_cast<size_t>(m_keyframeInterval)
+                || !sameLayout(info, referenceInfo);
+            current.resize(info.dataSize());
+            detail::packRows(m_rawSource.data, m_rawSource.step, current.data(), info.stride, info.height);
+            if (!keyframe) {
+                // 差分帧代替源像素送入常规 RAW 压缩流程；16 位图像按样本差分
+                m_deltaFrame.resize(current.size());
+                detail::subtractFrame(current.data(), m_referenceFrame.data(), current.size(), (info.depth + 7) / 8,
+                                      m_deltaFrame.data());
+                m_rawSource = cv::Mat(static_cast<int>(info.height), static_cast<int>(info.stride), CV_8UC1,
+                                      m_deltaFrame.data());
+            }
+
+            const auto result = compressInternal(!keyframe);
+            // m_rawSource 此时引用 m_deltaFrame，压缩后立即丢弃，之后的 compress() 不会把差分当作源图像
+            if (!keyframe) resetRawSource();
+            if (!result.success()) return result;
+            // 索引中帧长度为 LE32，超过 4 GiB 的帧无法记录
+            if (m_compressedData.size() > UINT32_MAX) {
+                return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Sequence frame exceeds 4 GiB");
+            }
+            file.write(reinterpret_cast<const char*>(m_compressedData.data()),
+                       static_cast<std::streamsize>(m_compressedData.size()));
+            if (!file.good()) {
+                return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write sequence file");
+            }
+
+            detail::SequenceFrame frame;
+            frame.offset = offset;
+            frame.size = static_cast<uint32_t>(m_compressedData.size());
+            frame.keyframe = keyframe;
+            index.frames.push_back(frame);
+            offset += m_compressedData.size();
+            total_original += result.original_size;
+            sinceKeyframe = keyframe ? 1 : sinceKeyframe + 1;
+            referenceInfo = info;
+            m_referenceFrame.swap(current);
+        }
+
+        if (index.frames.empty()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "No files processed successfully");
+        }
+
+        std::vector<unsigned char> indexData;
+        if (detail::writeSequenceIndex(index, indexData) == 0) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write sequence index");
+        }
+        file.write(reinterpret_cast<const char*>(indexData.data()), static_cast<std::streamsize>(indexData.size()));
+        if (!file.good()) {
+            return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, "Failed to write sequence file");
+        }
+
+        CompressionResult result;
+        result.original_size = total_original;
+        result.compressed_size = offset + indexData.size();
+        result.compression_ratio = static_cast<double>(result.compressed_size) / result.original_size;
+        result.result_code = CompressResult::SUCCESS;
+        return result;
+
+    } catch (const std::exception& e) {
+        return CompressionResult(CompressResult::ERROR_COMPRESS_FAILED, e.what());
+    }
+}
+
+CompressionResult ImageCompressor::decodeSequenceFrame(std::istream& file, uint64_t offset, uint32_t size,
+                                                       bool keyframe) {
+    clearResults();
+    if (!readFileRange(file, offset, size, m_compressedData)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to read sequence frame");
+    }
+    auto result = decompressInternal();
+    if (!result.success()) return result;
+    if (!m_rawInfo.valid()) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Sequence frame is not a raw image");
+    }
+
+    if (!keyframe) {
+        if (m_referenceFrame.size() != m_decompressedData.size()) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Sequence frame size mismatch");
+        }
+        detail::addFrame(m_decompressedData.data(), m_referenceFrame.data(), m_decompressedData.size(),
+                         (m_rawInfo.depth + 7) / 8);
+    }
+    m_referenceFrame = m_decompressedData;
+    return result;
+}
+
+CompressionResult ImageCompressor::decompressSequenceFrame(const std::string& sequenceFile, size_t frameIndex) {
+    clearResults();
+    std::ifstream file(sequenceFile, std::ios::binary);
+    detail::SequenceIndex index;
+    if (!file.is_open() || !readSequenceIndex(file, index)) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid sequence file");
+    }
+    if (frameIndex >= index.frames.size()) {
+        return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Frame index out of range");
+    }
+
+    // 从最近的关键帧开始依次叠加差分帧
+    CompressionResult result;
+    for (size_t i = detail::nearestKeyframe(index, frameIndex); i <= frameIndex; ++i) {
+        const detail::SequenceFrame& frame = index.frames[i];
+        result = decodeSequenceFrame(file, frame.offset, frame.size, frame.keyframe);
+        if (!result.success()) return result;
+    }
+    return result;
+}
+
+CompressionResult ImageCompressor::decompressSequence(const std::string& sequenceFile,
+                                                     const std::string& outputFolder) {
+    try {
+        if (!std::filesystem::create_directories(outputFolder) &&
+            !std::filesystem::exists(outputFolder)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Cannot create output directory");
+        }
+
+        std::ifstream file(sequenceFile, std::ios::binary);
+        detail::SequenceIndex index;
+        if (!file.is_open() || !readSequenceIndex(file, index)) {
+            return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Invalid sequence file");
+        }
+
+        const std::string stem = std::filesystem::path(sequenceFile).stem().string();
+        for (size_t i = 0; i < index.frames.size(); ++i) {
+            const detail::SequenceFrame& frame = index.frames[i];
+            const auto result = decodeSequenceFrame(file, frame.offset, frame.size, frame.keyframe);
+            if (!result.success()) return result;
+
+            char number[32];
+            std::snprintf(number, sizeof(number), "_%06zu.bmp", i);
+            if (!saveDecompressedImage(outputFolder + "/" + stem + number)) {
+                return CompressionResult(CompressResult::ERROR_DECOMPRESS_FAILED, "Failed to save sequence frame");
+            }
+        }
+
         return CompressionResult(CompressResult::SUCCESS);
 
     } catch (const std::exception& e) {
@@ -388,6 +2360,13 @@ CompressionResult ImageCompressor::decompressFolder(const std::string& inputFold
     }
 }
 
+size_t ImageCompressor::getSequenceFrameCount(const std::string& sequenceFile) {
+    std::ifstream file(sequenceFile, std::ios::binary);
+    detail::SequenceIndex index;
+    if (!file.is_open() || !readSequenceIndex(file, index)) return 0;
+    return index.frames.size();
+}
+
 bool ImageCompressor::isImageFile(const std::string& filename) {
     static const std::vector<std::string> extensions = {
         ".bmp", ".png", ".jpg", ".jpeg", ".tiff", ".tif", ".webp"
@@ -402,6 +2381,33 @@ bool ImageCompressor::isCompressedFile(const std::string& filename) {
     return ext == ".zstd" || ext == ".zst";
 }
 
+std::vector<std::vector<std::string>> ImageCompressor::clusterImageFiles(const std::string& folder, int numThreads) {
+    // 距离不超过该值的图像归为一组（0 为相同，1 为完全不同）
+    constexpr float kClusterThreshold = 0.2f;
+    const auto files = getImageFiles(folder);
+    std::vector<detail::ImageSignature> signatures(files.size());
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&]() {
+        for (size_t i = next++; i < files.size(); i = next++) {
+            signatures[i] = fileSignature(files[i]);
+        }
+    };
+    const size_t workers = std::clamp<size_t>(static_cast<size_t>(std::max(numThreads, 1)), 1,
+                                              std::max<size_t>(files.size(), 1));
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < workers; ++i) threads.emplace_back(worker);
+    worker();
+    for (auto& thread : threads) thread.join();
+
+    std::vector<std::vector<std::string>> groups;
+    for (const auto& cluster : detail::clusterSignatures(signatures, kClusterThreshold)) {
+        groups.emplace_back();
+        groups.back().reserve(cluster.size());
+        for (size_t i : cluster) groups.back().push_back(files[i]);
+    }
+    return groups;
+}
+
 std::vector<std::string> ImageCompressor::getImageFiles(const std::string& folder) {
     std::vector<std::string> files;
     try {
@@ -420,6 +2426,7 @@ std::vector<std::string> ImageCompressor::getImageFiles(const std::string& folde
 void ImageCompressor::clearResults() {
     m_compressedData.clear();
     m_decompressedData.clear();
+    m_rawInfo = RawImageInfo();
     m_qImage = QImage();
     m_cvMat = cv::Mat();
 }
@@ -431,7 +2438,41 @@ ImageCompressor::ZstdContext& ImageCompressor::getContext() {
     if (!m_ctx->dctx) {
         m_ctx->dctx = ZSTD_createDCtx();
     }
+    // CDict 的压缩参数在构建时确定，压缩级别变化后从缓存取得该级别的 CDict；
+    // 注册表中的字典一直有效，CDict 直接引用其映射内存
+    if (m_dictData && (!m_ctx->cdict || m_ctx->cdictLevel != m_level)) {
+        m_ctx->cdict = detail::CDictCache::instance().get(m_dictData, m_dictSize, m_dictChecksum, m_level,
+                                                          !m_dictionary);
+        m_ctx->cdictLevel = m_level;
+    }
     return *m_ctx;
 }
 
+void ImageCompressor::resetRawSource() {
+    m_originalInfo = RawImageInfo();
+    m_rawSource = cv::Mat();
+    m_rawSourceImage = QImage();
+    m_rawFileData.clear();
+}
+
+uint32_t ImageCompressor::rawTransforms(const RawImageInfo& info) const {
+    uint32_t transforms = m_constantTiles ? TRANSFORM_CONSTANT_TILES : TRANSFORM_NONE;
+    if (info.depth > 8 && m_shuffleMode != ShuffleMode::SHUFFLE_NONE) {
+        transforms |= TRANSFORM_BYTE_SHUFFLE;
+        // 位平面已经不是图像，不再叠加平面化和滤波
+        if (m_shuffleMode == ShuffleMode::SHUFFLE_BIT) return transforms | TRANSFORM_BIT_SHUFFLE;
+    }
+    // 平面化按字节拆分通道，多字节样本需要先做字节混洗
+    if (m_planarLayout && info.channels > 1 && (info.depth == 8 || (transforms & TRANSFORM_BYTE_SHUFFLE))) {
+        transforms |= TRANSFORM_PLANAR;
+    }
+    if (m_colorTransform == ColorTransform::COLOR_YCOCG_R && detail::supportsColorTransform(info)) {
+        transforms |= TRANSFORM_YCOCG_R;
+    }
+    if (m_filterMode == FilterMode::FILTER_ROW) transforms |= TRANSFORM_ROW_FILTER;
+    if (m_filterMode == FilterMode::FILTER_TILE) transforms |= TRANSFORM_TILE_FILTER;
+    if (m_channelReduction && detail::supportsChannelReduction(info)) transforms |= TRANSFORM_CHANNEL_REDUCE;
+    return transforms;
+}
+
 } // namespace zstd_compressor
\ No newline at end of file
@@ -3,7 +3,10 @@
 
 #include <vector>
 #include <string>
+#include <iosfwd>
 #include <memory>
+#include <functional>
+#include <cstdint>
 #include <QImage>
 #include <zstd.h>
 #include <opencv2/opencv.hpp>
@@ -20,7 +23,55 @@
 
 namespace zstd_compressor {
 
-    enum class ImageFormat { FORMAT_BMP, FORMAT_PNG, FORMAT_JPEG };
+    namespace detail {
+        struct PackEntry;
+        struct PackReader;
+    }
+
+    // FORMAT_RAW: 直接压缩像素行，不经过 BMP/PNG/JPEG 编码
+    enum class ImageFormat { FORMAT_BMP, FORMAT_PNG, FORMAT_JPEG, FORMAT_RAW };
+
+    // 像素在内存中的字节顺序
+    enum class PixelFormat : uint8_t {
+        PIXEL_UNKNOWN = 0,
+        PIXEL_GRAY8,
+        PIXEL_BGR888,    // cv::Mat CV_8UC3
+        PIXEL_BGRA8888,  // cv::Mat CV_8UC4 / QImage::Format_ARGB32
+        PIXEL_BGRX8888,  // QImage::Format_RGB32
+        PIXEL_RGB888,    // QImage::Format_RGB888
+        PIXEL_RGBA8888,  // QImage::Format_RGBA8888
+        PIXEL_GRAY16,    // cv::Mat CV_16UC1 / QImage::Format_Grayscale16
+        PIXEL_BGR161616, // cv::Mat CV_16UC3
+        PIXEL_BGRA16161616 // cv::Mat CV_16UC4
+    };
+
+    // RAW 模式下的预测滤波方式
+    enum class FilterMode {
+        FILTER_NONE,
+        FILTER_ROW,  // 逐行选择滤波器
+        FILTER_TILE  // 按 64x64 块以熵估计选择滤波器，适合混合内容
+    };
+
+    // RAW 模式下的颜色变换
+    enum class ColorTransform { COLOR_NONE, COLOR_YCOCG_R };
+
+    // RAW 模式下多字节样本（16 位）的混洗方式
+    enum class ShuffleMode { SHUFFLE_NONE, SHUFFLE_BYTE, SHUFFLE_BIT };
+
+    // RAW 数据在 zstd 之前经过的可逆预处理（位组合，记录在头部）
+    enum RawTransform : uint32_t {
+        TRANSFORM_NONE = 0,
+        TRANSFORM_ROW_FILTER = 1u << 0,  // PNG 风格逐行滤波，每行前置 1 字节滤波类型
+        TRANSFORM_PLANAR = 1u << 1,      // 通道拆分为独立平面（BGRBGR... -> BB..GG..RR..）
+        TRANSFORM_YCOCG_R = 1u << 2,     // 无损 YCoCg-R 颜色去相关
+        TRANSFORM_BYTE_SHUFFLE = 1u << 3, // 多字节样本按字节拆成独立字节流（低字节流在前）
+        TRANSFORM_BIT_SHUFFLE = 1u << 4, // 字节流再拆成位平面（需与 BYTE_SHUFFLE 同时使用）
+        TRANSFORM_TILE_FILTER = 1u << 5, // 分块自适应滤波，payload 前部为块滤波映射表
+        TRANSFORM_PALETTE = 1u << 6,     // 调色板 + 1/2/4/8 位索引，独占，不与其它变换组合
+        TRANSFORM_CHANNEL_REDUCE = 1u << 7, // 去掉灰度重复通道和常量 Alpha，payload 末尾 2 字节记录标志和 Alpha 值
+        TRANSFORM_CONSTANT_TILES = 1u << 8  // 纯色块只记录像素值，其余块堆叠后再做其它变换，位图放在 payload 末尾
+    };
+
     enum class CompressResult { SUCCESS, ERROR_EMPTY_DATA, ERROR_COMPRESS_FAILED, ERROR_DECOMPRESS_FAILED };
 
     struct CompressionResult {
@@ -29,6 +80,8 @@ namespace zstd_compressor {
         double compression_ratio = 0.0;
         CompressResult result_code = CompressResult::ERROR_EMPTY_DATA;
         std::string error_message;
+        // 平面化的贡献：关闭平面化时的压缩大小 / 实际压缩大小（采样估计，需 setPlanarGainEstimate(true)，否则为 0）
+        double planar_gain = 0.0;
 
         CompressionResult() = default;
         CompressionResult(CompressResult code, const std::string& msg = "")
@@ -37,6 +90,21 @@ namespace zstd_compressor {
         bool success() const { return result_code == CompressResult::SUCCESS; }
     };
 
+    // RAW 模式的像素描述，随压缩数据一起保存
+    struct RawImageInfo {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t stride = 0;   // 每行字节数（紧凑存储，不含填充）
+        uint8_t channels = 0;
+        uint8_t depth = 0;     // 每通道位数
+        PixelFormat format = PixelFormat::PIXEL_UNKNOWN;
+        uint32_t transforms = TRANSFORM_NONE; // RawTransform 位组合
+        uint64_t checksum = 0; // 像素内容的 XXH64，解压后校验；0 表示未记录（旧版本数据）
+
+        bool valid() const { return width > 0 && height > 0 && channels > 0 && depth > 0; }
+        size_t dataSize() const { return static_cast<size_t>(stride) * height; }
+    };
+
     class BMP_API ImageCompressor {
     public:
         explicit ImageCompressor(int level = 3);
@@ -51,7 +119,23 @@ namespace zstd_compressor {
         // 设置参数
         void setCompressionLevel(int level);
         void setImageFormat(ImageFormat format);
-        void setNumThreads(int num_threads);
+        void setColorTransform(ColorTransform transform); // 仅对 FORMAT_RAW 8 位彩色图像生效
+        void setNumThreads(int num_threads); // zstd 工作线程数；0 表示在调用线程内单线程压缩（不经过 ZSTDMT）
+        void setFilterMode(FilterMode mode); // 仅对 FORMAT_RAW 生效
+        void setPlanarLayout(bool enabled);  // 仅对 FORMAT_RAW 多通道图像生效
+        void setPlanarGainEstimate(bool enabled); // 压缩后额外压缩两次采样估计 planar_gain，默认关闭
+        void setShuffleMode(ShuffleMode mode); // 仅对 FORMAT_RAW 16 位图像生效，默认字节混洗
+        void setPaletteMode(bool enabled);     // 仅对 FORMAT_RAW 8 位图像生效，颜色数不超过 256 时自动启用
+        void setChannelReduction(bool enabled); // 仅对 FORMAT_RAW 8 位彩色图像生效
+        void setConstantTileSkipping(bool enabled); // 仅对 FORMAT_RAW 生效，纯色块不进入 zstd
+        void setKeyframeInterval(int interval); // 图像序列中关键帧的间隔（帧数），默认 30
+        void setRowMatchFinder(bool enabled);   // 实验性，默认关闭；仅对 FORMAT_RAW 生效，按行跨度查找“上方像素”匹配，启用时单线程压缩
+        void setTileSize(int tileSize);         // 仅对 FORMAT_RAW 生效，>0 时按 tileSize x tileSize 分块独立压缩，默认 0（不分块）
+        void setBandRows(int rows);             // 仅对 FORMAT_RAW 生效，>0 时按 rows 行切成横向条带独立压缩，解压时多线程并行；分块优先
+        void setPyramidLevels(int levels);      // 仅对 FORMAT_RAW 生效，额外保存 levels 层逐级缩小一半的预览图（长边到 64 像素为止），默认 0
+        void setSolidBlockSize(int blockSize);  // 打包时把（预处理后）小于 blockSize 字节的图像依次拼成固实块压缩，默认 0（逐个压缩）
+        void setLongDistanceMatching(bool enabled); // 固实块启用长距离匹配，窗口覆盖整个块
+        void setSimilarityGrouping(bool enabled);   // 打包时按图像相似度聚类代替文件名顺序，同簇图像相邻存放，固实块优先在簇边界断开
 
         // 加载图像
         bool loadImage(const std::string& filename);
@@ -71,6 +155,23 @@ namespace zstd_compressor {
         CompressionResult decompressFromFile(const std::string& filename);
         CompressionResult decompressFromFile(const QString& filename);
 
+        // 按 RAW 头部（宽、高、格式、行字节数、预处理链、校验和）预先分配 cv::Mat / QImage，
+        // 像素直接解压到其内存，不经过 getDecompressedData() 的中间缓冲区和二次解码；
+        // 尺寸和格式与传入的图像相同时复用其内存。非 RAW 数据退回常规解压后解码
+        CompressionResult decompressToMat(const std::vector<unsigned char>& compressedData, cv::Mat& image);
+        CompressionResult decompressToQImage(const std::vector<unsigned char>& compressedData, QImage& image);
+
+        // 分块图像的区域解码：只解压与区域相交的块（多线程），结果为区域大小的 RAW 像素，
+        // 区域超出图像的部分会被裁掉。不带文件名时对当前的压缩数据操作
+        CompressionResult decompressRegion(int x, int y, int width, int height);
+        CompressionResult decompressRegion(const std::string& filename, int x, int y, int width, int height);
+        static RawImageInfo getTiledImageInfo(const std::string& filename); // 非分块文件返回无效描述
+
+        // 多分辨率金字塔：level 0 为原图，第 k 层缩小 2^k 倍；带文件名时只读取该层的数据
+        CompressionResult decompressLevel(int level);
+        CompressionResult decompressLevel(const std::string& filename, int level);
+        static int getPyramidLevelCount(const std::string& filename); // 含原图层，非金字塔文件返回 0
+
         // 保存结果
         bool saveCompressedData(const std::string& filename) const;
         bool saveDecompressedImage(const std::string& filename) const;
@@ -80,43 +181,157 @@ namespace zstd_compressor {
         cv::Mat getCVMat() const;
         const std::vector<unsigned char>& getCompressedData() const;
         const std::vector<unsigned char>& getDecompressedData() const;
+        const RawImageInfo& getRawImageInfo() const;
+        bool isRawImage() const;
 
-        // 批量处理
+        // 批量处理：numWorkers 大于 1 时按文件并行，每个工作线程使用复制了当前设置（包括字典）的
+        // 独立实例，各自拥有 CCtx / DCtx 和缓冲区，文件内不再多线程；统计在全部完成后汇总
         CompressionResult compressFolder(const std::string& inputFolder,
-                                        const std::string& outputFolder);
+                                        const std::string& outputFolder, int numWorkers = 1);
         CompressionResult decompressFolder(const std::string& inputFolder,
-                                         const std::string& outputFolder);
+                                         const std::string& outputFolder, int numWorkers = 1);
+
+        // 打包文件：文件夹中的所有图像压缩后顺序写入同一个文件，文件末尾的索引记录
+        // （文件名、偏移、长度、字典 ID、校验和）。读取时内存映射整个文件，按文件名 O(1) 查找并直接
+        // 从映射内存解压，不再为每个图像打开一个文件。设置了固实块大小时，小图像按文件名顺序拼成
+        // 一个 zstd 帧共享窗口，读取其中一个图像只需解压它所在的块
+        CompressionResult compressFolderToPack(const std::string& inputFolder, const std::string& packFile);
+        CompressionResult decompressPack(const std::string& packFile, const std::string& outputFolder);
+        bool openPack(const std::string& packFile);
+        void closePack();
+        CompressionResult readEntry(const std::string& name); // 需先 openPack，name 为原文件名（不含目录）
+        std::vector<std::string> getPackEntryNames() const;
+
+        // 字典：用样本图像（按当前设置预处理后的数据，单个样本最多取前 128 KB）训练 zstd 字典，
+        // fastCover 多线程搜索参数，训练结果写入 dictFile 并立即加载。加载字典后，压缩和解压都使用
+        // 预先构建的 CDict / DDict，字典 ID 记录在每个 zstd 帧中。CDict 来自进程内共享的缓存，
+        // 同一字典在同一级别下只解析一次，所有实例和线程共用
+        CompressionResult trainDictionary(const std::string& sampleFolder, const std::string& dictFile,
+                                          size_t maxDictSize = 112640);
+        CompressionResult trainDictionary(const std::vector<std::string>& sampleFiles, const std::string& dictFile,
+                                          size_t maxDictSize = 112640);
+        bool loadDictionary(const std::string& dictFile);
+        bool loadDictionary(const std::vector<unsigned char>& dictionary);
+        void clearDictionary();
+        unsigned getDictionaryID() const; // 未加载字典时返回 0
+        bool useRegisteredDictionary(unsigned dictID); // 用注册表中的字典压缩，不复制字典内容
+
+        // 全局字典注册表：进程内所有 ImageCompressor 共享，解压时按帧中的字典 ID 自动选择，调用方无需
+        // 知道数据用哪个字典压缩。字典文件只读映射，DDict 按引用构建，注册后在进程结束前一直有效
+        static unsigned registerDictionary(const std::string& dictFile); // 返回字典 ID，失败返回 0
+        static size_t registerDictionaries(const std::string& folder);   // 注册文件夹中的所有 .dict 文件，返回成功的个数
+        static std::vector<unsigned> getRegisteredDictionaryIDs();
+        static void clearDictionaryCache(); // 释放共享缓存中暂时没有实例使用的 CDict
+
+        // 字典老化后自动重新训练：使用字典的单帧压缩按字典统计压缩率，变差超过 degradation（相对最初的
+        // 基准）时用近期输入的水库抽样在后台训练新字典。新字典保存为 dictFolder 中的 <字典 ID>.dict 并注册
+        // 后才发布，之后各实例在下一次压缩时切换；旧字典同样保存并注册，以前的数据始终可以解压
+        static bool enableDictionaryRetraining(const std::string& dictFolder, double degradation = 0.1,
+                                               size_t reservoirSamples = 512);
+        static void disableDictionaryRetraining();
+        static void waitForDictionaryRetraining(); // 等待正在进行的后台训练结束
+
+        // 图像序列（仅 FORMAT_RAW）：文件夹中的帧按文件名顺序写入同一文件，关键帧之间的帧
+        // 只保存与上一帧的逐样本差分；文件末尾的索引支持从最近的关键帧开始解码任意一帧
+        CompressionResult compressSequence(const std::string& inputFolder, const std::string& outputFile);
+        CompressionResult decompressSequenceFrame(const std::string& sequenceFile, size_t frameIndex);
+        CompressionResult decompressSequence(const std::string& sequenceFile, const std::string& outputFolder);
+        static size_t getSequenceFrameCount(const std::string& sequenceFile);
 
         // 静态工具函数
         static bool isImageFile(const std::string& filename);
         static bool isCompressedFile(const std::string& filename);
         static std::vector<std::string> getImageFiles(const std::string& folder);
+        // 按签名（字节直方图 + 8x8 均值哈希，多线程计算）把文件夹中的图像聚成相似的组，
+        // 每组可作为一个固实压缩分组或字典训练集；组按出现顺序排列，组内保持文件名顺序
+        static std::vector<std::vector<std::string>> clusterImageFiles(const std::string& folder, int numThreads = 1);
 
     private:
         struct ZstdContext {
             ZSTD_CCtx* cctx = nullptr;
             ZSTD_DCtx* dctx = nullptr;
+            std::shared_ptr<const ZSTD_CDict> cdict; // 全局缓存中 m_dictData 在 cdictLevel 下的 CDict，级别变化时重新取得
+            int cdictLevel = 0;
+            std::shared_ptr<const ZSTD_DDict> ddict; // loadDictionary 加载的字典，并行工作实例共用；注册表中的字典解压时由注册表提供
             ~ZstdContext();
         };
 
         int m_level;
         int m_num_threads;
         ImageFormat m_format;
+        ColorTransform m_colorTransform;
+        FilterMode m_filterMode;
+        bool m_planarLayout;
+        bool m_planarGainEstimate;
+        ShuffleMode m_shuffleMode;
+        bool m_paletteMode;
+        bool m_channelReduction;
+        bool m_constantTiles;
+        int m_keyframeInterval;
+        bool m_rowMatchFinder;
+        int m_tileSize;
+        int m_bandRows;
+        int m_pyramidLevels;
+        int m_solidBlockSize;
+        bool m_longDistanceMatching;
+        bool m_similarityGrouping;
         std::vector<unsigned char> m_originalData;
         std::vector<unsigned char> m_compressedData;
         std::vector<unsigned char> m_decompressedData;
+        std::shared_ptr<const std::vector<unsigned char>> m_dictionary; // loadDictionary 加载的字典内容，并行工作实例共用
+        const unsigned char* m_dictData;         // 压缩使用的字典：m_dictionary 或注册表中映射的字典
+        size_t m_dictSize;
+        uint64_t m_dictChecksum;
+        std::vector<unsigned char> m_workBuffer; // RAW 预处理后的中间数据，跨调用复用
+        RawImageInfo m_originalInfo; // RAW 模式下源像素的描述
+        cv::Mat m_rawSource;         // RAW 模式的源像素，引用 cv::Mat / QImage 的内存而不拷贝
+        QImage m_rawSourceImage;     // 源为 QImage 时保持其像素内存有效
+        std::vector<unsigned char> m_rawFileData; // 源为 BMP 文件时 m_rawSource 引用的文件内容或展开后的像素
+        RawImageInfo m_rawInfo;      // RAW 数据解压后 m_decompressedData 的像素描述
+        std::vector<unsigned char> m_referenceFrame; // 序列压缩 / 解压时上一帧的紧凑像素
+        std::vector<unsigned char> m_deltaFrame;     // 序列压缩时当前帧与上一帧的差分
         mutable QImage m_qImage; // mutable 用于延迟加载
         mutable cv::Mat m_cvMat;
 
         std::unique_ptr<ZstdContext> m_ctx;
+        std::unique_ptr<detail::PackReader> m_pack; // openPack 打开的映射文件
 
         bool loadImageFile(const std::string& filename);
+        void copySettingsTo(ImageCompressor& other) const;
+        // 对 count 个任务调用 task(实例, 工作线程序号, 任务序号)；只有一个工作线程时直接使用当前实例
+        void forEachParallel(size_t count, int numWorkers,
+                             const std::function<void(ImageCompressor&, size_t, size_t)>& task);
         bool convertToImageData(const QImage& image);
         bool convertToImageData(const cv::Mat& image);
-        CompressionResult compressInternal();
+        bool convertToRawData(const QImage& image);
+        bool convertToRawData(const cv::Mat& image);
+        bool loadRawBmp(std::vector<unsigned char> data);
+        static QImage rawToQImage(const RawImageInfo& info, const unsigned char* pixels, size_t stride);
+        static cv::Mat rawToCVMat(const RawImageInfo& info, const unsigned char* pixels, size_t stride);
+        static QImage decodeQImage(const std::vector<unsigned char>& data);
+        static cv::Mat decodeCVMat(const std::vector<unsigned char>& data);
+        CompressionResult compressInternal(bool deltaFrame = false); // deltaFrame：序列的差分帧
         CompressionResult decompressInternal();
+        bool prepareRawPayload(RawImageInfo& info, const unsigned char* pixels, size_t stride,
+                               std::vector<unsigned char>& payload, const unsigned char*& input, size_t& inputSize) const;
+        CompressionResult compressRawFrame(ZSTD_CCtx* cctx, RawImageInfo& info, const unsigned char* pixels,
+                                           size_t stride, int numThreads, std::vector<unsigned char>& payload,
+                                           std::vector<unsigned char>& out) const;
+        CompressionResult compressTiled();
+        CompressionResult compressPyramid();
+        CompressionResult decodeImageData(const unsigned char* src, size_t size);
+        CompressionResult decodeRawImage(const unsigned char* src, size_t size, unsigned char* dst, size_t dstStride);
+        CompressionResult decodeTiledRegion(const unsigned char* src, size_t size, int x, int y, int width, int height);
+        bool buildSolidMember(std::vector<unsigned char>& member);
+        CompressionResult compressSolidBlock(const std::vector<unsigned char>& block, std::vector<unsigned char>& out);
+        CompressionResult decodePackEntry(const detail::PackEntry& entry);
+        CompressionResult decodeSolidMember(const unsigned char* src, size_t size);
+        CompressionResult decodeSequenceFrame(std::istream& file, uint64_t offset, uint32_t size, bool keyframe);
         void clearResults();
         ZstdContext& getContext();
+        void resetRawSource();
+        uint32_t rawTransforms(const RawImageInfo& info) const;
+        double estimatePlanarGain(const RawImageInfo& info);
     };
 
 } // namespace zstd_compressor
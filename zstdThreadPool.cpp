@@ -0,0 +1,29 @@
+#define ZSTD_STATIC_LINKING_ONLY
+#include "zstdThreadPool.h"
+#include <algorithm>
+#include <thread>
+
+namespace zstd_compressor {
+namespace detail {
+
+namespace {
+
+ZSTD_threadPool* sharedThreadPool() {
+    // 有意不释放：静态对象析构时可能仍有压缩上下文引用线程池
+    static ZSTD_threadPool* pool = ZSTD_createThreadPool(std::max(1u, std::thread::hardware_concurrency()));
+    return pool;
+}
+
+} // namespace
+
+size_t configureCompression(ZSTD_CCtx* cctx, int level, int nbWorkers) {
+    size_t code = ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+    if (ZSTD_isError(code)) return code;
+    code = ZSTD_CCtx_setParameter(cctx, ZSTD_c_nbWorkers, nbWorkers);
+    if (ZSTD_isError(code)) return code;
+    // 线程池创建失败时退回每个上下文自己的线程
+    return nbWorkers > 0 ? ZSTD_CCtx_refThreadPool(cctx, sharedThreadPool()) : 0;
+}
+
+} // namespace detail
+} // namespace zstd_compressor
@@ -0,0 +1,17 @@
+#ifndef ZSTDTHREADPOOL_H
+#define ZSTDTHREADPOOL_H
+
+#include <cstddef>
+#include <zstd.h>
+
+namespace zstd_compressor {
+namespace detail {
+
+    // 设置压缩级别和 zstd 工作线程数，并让 cctx 使用进程内共享的线程池（线程数等于硬件线程数）：
+    // 实例再多，zstd 的后台线程总数也不会超过核心数。返回第一个被拒绝的设置的 zstd 错误码，全部成功返回 0
+    size_t configureCompression(ZSTD_CCtx* cctx, int level, int nbWorkers);
+
+} // namespace detail
+} // namespace zstd_compressor
+
+#endif // ZSTDTHREADPOOL_H